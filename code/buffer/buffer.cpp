@@ -1,12 +1,21 @@
 #include "buffer.h"
 
 Buffer::Buffer(int initBuffSize):
-    buffer_(initBuffSize),
+    buffer_(nullptr),
+    cap_(0),
+    initSize_(initBuffSize > 0 ? initBuffSize : 0),
     readPos_(0),
-    writePos_(0) {}
+    writePos_(0) {
+    /* 先于任何 Buffer 构造内存池，保证析构时归还的块有处可去 */
+    BufferPool::Instance();
+}
+
+Buffer::~Buffer() {
+    BufferPool::Instance()->Return(buffer_, cap_);
+}
 
 size_t Buffer::WritableBytes() const {
-    return buffer_.size() - writePos_;
+    return cap_ - writePos_;
 }
 
 size_t Buffer::ReadableBytes() const {
@@ -43,7 +52,15 @@ void Buffer::RetrieveUntil(const char* end) {
 }
 
 void Buffer::RetrieveAll() {
-    bzero(&buffer_[0], buffer_.size());
+    readPos_ = 0;
+    writePos_ = 0;
+}
+
+void Buffer::Release() {
+    if(!buffer_ || ReadableBytes() > 0) return;
+    BufferPool::Instance()->Return(buffer_, cap_);
+    buffer_ = nullptr;
+    cap_ = 0;
     readPos_ = 0;
     writePos_ = 0;
 }
@@ -68,7 +85,7 @@ void Buffer::Append(const char* str, size_t len) {
     HasWritten(len);
 }
 
-void Buffer::Append(const std::string& str) {
+void Buffer::Append(std::string_view str) {
     Append(str.data(), str.size());
 }
 
@@ -99,7 +116,7 @@ ssize_t Buffer::ReadFd(int fd, int* saveErrno) {
         writePos_ += len;
     }
     else {
-        writePos_ = buffer_.size();
+        writePos_ = cap_;
         Append(buff, len - writable);
     }
     return len;
@@ -118,16 +135,26 @@ ssize_t Buffer::WriteFd(int fd, int* saveErrno) {
 }
 
 char* Buffer::BeginPtr_() {
-    return buffer_.data();
+    return buffer_;
 }
 
 const char* Buffer::BeginPtr_() const {
-    return buffer_.data();
+    return buffer_;
 }
 
 void Buffer::MakeSpace_(size_t len) {
     if(WritableBytes() + PrependableBytes() < len) {
-        buffer_.resize(writePos_ + len + 1);
+        /* 换一个能容纳可读数据与新写入的块，已检索的前置区域不再保留 */
+        size_t readable = ReadableBytes();
+        size_t need = readable + len > initSize_ ? readable + len : initSize_;
+        size_t cap = 0;
+        char* block = BufferPool::Instance()->Lease(need, &cap);
+        if(readable > 0) memcpy(block, BeginPtr_() + readPos_, readable);
+        BufferPool::Instance()->Return(buffer_, cap_);
+        buffer_ = block;
+        cap_ = cap;
+        readPos_ = 0;
+        writePos_ = readable;
     }
     else {
         size_t readable = ReadableBytes();
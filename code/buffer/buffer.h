@@ -11,12 +11,25 @@
 #include <unistd.h>  // write
 #include <sys/uio.h> //readv
 #include <vector> //readv
+#include <string_view>
 #include <atomic>
 #include <assert.h>
+#include "bufferpool.h"
+
+/*
+ * Buffer: 读写指针管理的连续字节缓冲区。
+ * 存储块从 BufferPool 租用，首次写入时才申请；空间不足时先把可读数据搬到块首，
+ * 仍不够再换一个更大的块。Release 在缓冲区为空时把块交还池中。
+ */
 class Buffer {
 public:
+    /**
+     * @param initBuffSize 首次写入时至少申请的容量
+     */
     Buffer(int initBuffSize = 1024);
-    ~Buffer() = default;
+    ~Buffer();
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
 
     /**
      * 可写字节数
@@ -54,9 +67,17 @@ public:
     void RetrieveUntil(const char* end);
 
     /**
-     * 检索全部可读数据（重置缓冲区）
+     * 检索全部可读数据（重置缓冲区，保留存储块）
      */
     void RetrieveAll() ;
+    /**
+     * 没有可读数据时把存储块交还 BufferPool，之后的写入重新租用
+     */
+    void Release();
+    /**
+     * 当前持有的存储块容量
+     */
+    size_t Capacity() const { return cap_; }
     /**
      * 将全部可读数据作为 std::string 返回并清空缓冲区
      */
@@ -78,7 +99,7 @@ public:
     /**
      * 追加数据（字符串）到缓冲区
      */
-    void Append(const std::string& str);
+    void Append(std::string_view str);
     /**
      * 追加任意数据到缓冲区
      */
@@ -105,7 +126,9 @@ private:
     const char* BeginPtr_() const;
     void MakeSpace_(size_t len);
 
-    std::vector<char> buffer_;
+    char* buffer_;      /* 从 BufferPool 租用的块，未写入过或已 Release 时为空 */
+    size_t cap_;
+    size_t initSize_;
     std::atomic<std::size_t> readPos_;
     std::atomic<std::size_t> writePos_;
 };
@@ -0,0 +1,126 @@
+#include "bufferpool.h"
+
+BufferPool::BufferPool(): pooled_(0), leased_(0) {}
+
+BufferPool* BufferPool::Instance() {
+    /* 有意不析构：连接与日志的缓冲区、线程缓存可能在静态对象析构之后才归还块 */
+    static BufferPool* inst = new BufferPool();
+    return inst;
+}
+
+/* 本线程的 LocalCache 已析构。只是一个 bool，常量初始化，线程退出的任何阶段都可以安全读取 */
+static thread_local bool localDead = false;
+
+BufferPool::LocalCache::~LocalCache() {
+    localDead = true;
+    BufferPool* pool = BufferPool::Instance();
+    for(int cls = 0; cls < CLASS_NUM; cls++) {
+        pool->Drain_(cls, blocks[cls], 0);
+    }
+}
+
+BufferPool::LocalCache* BufferPool::Local_() {
+    if(localDead) return nullptr;
+    static thread_local LocalCache cache;
+    return &cache;
+}
+
+int BufferPool::ClassOf_(size_t size) {
+    int cls = 0;
+    while(cls < CLASS_NUM && ClassSize_(cls) < size) cls++;
+    return cls;
+}
+
+char* BufferPool::Lease(size_t size, size_t* cap) {
+    assert(cap);
+    int cls = ClassOf_(size);
+    if(cls == CLASS_NUM) {
+        /* 超过最大分级的块不入池 */
+        *cap = size;
+        leased_.fetch_add(size, std::memory_order_relaxed);
+        return static_cast<char*>(malloc(size));
+    }
+    *cap = ClassSize_(cls);
+    leased_.fetch_add(*cap, std::memory_order_relaxed);
+    LocalCache* cache = Local_();
+    if(!cache) return LeaseGlobal_(cls);
+    std::vector<char*>& local = cache->blocks[cls];
+    if(local.empty()) Refill_(cls, local);
+    if(local.empty()) return static_cast<char*>(malloc(*cap));
+    char* block = local.back();
+    local.pop_back();
+    return block;
+}
+
+void BufferPool::Return(char* block, size_t cap) {
+    if(!block) return;
+    leased_.fetch_sub(cap, std::memory_order_relaxed);
+    int cls = ClassOf_(cap);
+    if(cls == CLASS_NUM || ClassSize_(cls) != cap) {
+        free(block);
+        return;
+    }
+    LocalCache* cache = Local_();
+    if(!cache) {
+        ReturnGlobal_(cls, block);
+        return;
+    }
+    std::vector<char*>& local = cache->blocks[cls];
+    if(local.size() >= LOCAL_MAX) Drain_(cls, local, LOCAL_MAX / 2);
+    local.push_back(block);
+}
+
+void BufferPool::Refill_(int cls, std::vector<char*>& local) {
+    std::lock_guard<std::mutex> locker(mtx_);
+    std::vector<char*>& global = free_[cls];
+    while(!global.empty() && local.size() < LOCAL_MAX / 2) {
+        local.push_back(global.back());
+        global.pop_back();
+        pooled_ -= ClassSize_(cls);
+    }
+}
+
+void BufferPool::Drain_(int cls, std::vector<char*>& local, size_t keep) {
+    std::lock_guard<std::mutex> locker(mtx_);
+    while(local.size() > keep) {
+        char* block = local.back();
+        local.pop_back();
+        if(pooled_ + ClassSize_(cls) > GLOBAL_MAX_BYTES) {
+            free(block);
+            continue;
+        }
+        free_[cls].push_back(block);
+        pooled_ += ClassSize_(cls);
+    }
+}
+
+char* BufferPool::LeaseGlobal_(int cls) {
+    {
+        std::lock_guard<std::mutex> locker(mtx_);
+        std::vector<char*>& global = free_[cls];
+        if(!global.empty()) {
+            char* block = global.back();
+            global.pop_back();
+            pooled_ -= ClassSize_(cls);
+            return block;
+        }
+    }
+    return static_cast<char*>(malloc(ClassSize_(cls)));
+}
+
+void BufferPool::ReturnGlobal_(int cls, char* block) {
+    {
+        std::lock_guard<std::mutex> locker(mtx_);
+        if(pooled_ + ClassSize_(cls) <= GLOBAL_MAX_BYTES) {
+            free_[cls].push_back(block);
+            pooled_ += ClassSize_(cls);
+            return;
+        }
+    }
+    free(block);
+}
+
+BufferPool::Stats BufferPool::GetStats() {
+    std::lock_guard<std::mutex> locker(mtx_);
+    return Stats{leased_.load(std::memory_order_relaxed), pooled_};
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+/*
+ * @Date         : 2026-10-18
+ * @copyleft Apache 2.0
+ */
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <stdlib.h>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <assert.h>
+
+/*
+ * BufferPool: Buffer 存储块的分级内存池。
+ * 块大小按 4 KB 起的 2 的幂分级，每个线程先在自己的缓存中存取，
+ * 缓存满或空时再与全局空闲链表成批交换，全局链表超过上限的块归还给系统。
+ * 空闲的长连接把读写缓冲区的块交还池中，大量空闲连接时每个连接几乎不占缓冲区内存。
+ */
+class BufferPool {
+public:
+    static BufferPool* Instance();
+
+    /**
+     * 租用至少 size 字节的块
+     * @param cap 输出：块的实际容量
+     */
+    char* Lease(size_t size, size_t* cap);
+
+    /**
+     * 归还 Lease 得到的块
+     * @param cap Lease 返回的容量
+     */
+    void Return(char* block, size_t cap);
+
+    struct Stats {
+        size_t leased;     /* 已租出的字节数 */
+        size_t pooled;     /* 全局空闲链表中的字节数（不含各线程缓存） */
+    };
+    Stats GetStats();
+
+    static const size_t MIN_BLOCK = 4096;
+    static const int CLASS_NUM = 9;                         /* 4 KB ~ 1 MB，更大的块直接向系统申请 */
+    static const size_t LOCAL_MAX = 16;                     /* 每个线程每级最多缓存的块数 */
+    static const size_t GLOBAL_MAX_BYTES = 64 << 20;        /* 全局空闲链表的总容量上限 */
+
+private:
+    BufferPool();
+
+    /* 线程退出时把缓存的块交还全局链表 */
+    struct LocalCache {
+        std::vector<char*> blocks[CLASS_NUM];
+        ~LocalCache();
+    };
+
+    static int ClassOf_(size_t size);
+    static size_t ClassSize_(int cls) { return MIN_BLOCK << cls; }
+    /**
+     * 当前线程的缓存；线程退出时缓存已析构后返回空（之后析构的 thread_local 对象仍可能归还块）
+     */
+    static LocalCache* Local_();
+
+    /**
+     * 从全局链表取最多 LOCAL_MAX / 2 块放入线程缓存
+     */
+    void Refill_(int cls, std::vector<char*>& local);
+    /**
+     * 线程缓存满时把一半交还全局链表
+     */
+    void Drain_(int cls, std::vector<char*>& local, size_t keep);
+    /**
+     * 没有线程缓存时直接从全局链表取一块，链表为空时向系统申请
+     */
+    char* LeaseGlobal_(int cls);
+    /**
+     * 没有线程缓存时直接把块交还全局链表，超过上限时归还给系统
+     */
+    void ReturnGlobal_(int cls, char* block);
+
+    std::mutex mtx_;
+    std::vector<char*> free_[CLASS_NUM];
+    size_t pooled_;
+    std::atomic<size_t> leased_;
+};
+
+#endif //BUFFER_POOL_H
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "ringbuffer.h"
+
+#include <algorithm>   // max
+
+/* 向上取整到页大小 */
+static size_t PageAlign(size_t size) {
+    static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    if(size == 0) size = 1;
+    return (size + page - 1) / page * page;
+}
+
+RingBuffer::RingBuffer(size_t capacity):
+        base_(nullptr), cap_(0), initCap_(PageAlign(capacity)), head_(0), len_(0), mirrored_(false) {}
+
+RingBuffer::~RingBuffer() {
+    Free_();
+}
+
+char* RingBuffer::MapMirror_(size_t cap) {
+    int fd = memfd_create("ringbuffer", MFD_CLOEXEC);
+    if(fd < 0) return nullptr;
+    if(ftruncate(fd, cap) < 0) {
+        close(fd);
+        return nullptr;
+    }
+    /* 先占住 2 * cap 的连续地址，再把 memfd 固定映射到前后两半 */
+    void* area = mmap(nullptr, cap * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(area == MAP_FAILED) {
+        close(fd);
+        return nullptr;
+    }
+    char* base = static_cast<char*>(area);
+    bool ok = mmap(base, cap, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED
+           && mmap(base + cap, cap, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED;
+    /* 映射建立后 fd 不再需要，内存随映射一起释放 */
+    close(fd);
+    if(!ok) {
+        munmap(base, cap * 2);
+        return nullptr;
+    }
+    return base;
+}
+
+void RingBuffer::Free_() {
+    if(!base_) return;
+    if(mirrored_) munmap(base_, cap_ * 2);
+    else free(base_);
+    base_ = nullptr;
+}
+
+void RingBuffer::EnsureWriteable(size_t len) {
+    if(WritableBytes() >= len) return;
+    if(!mirrored_ && cap_ - len_ >= len) {
+        /* 退化实现：空间够但不连续，把可读数据搬到起始处 */
+        memmove(base_, base_ + head_, len_);
+        head_ = 0;
+        return;
+    }
+    Grow_(len);
+}
+
+void RingBuffer::Grow_(size_t len) {
+    size_t cap = std::max({cap_ * 2, len_ + len, initCap_});
+    cap = PageAlign(cap);
+    char* base = MapMirror_(cap);
+    bool mirrored = base != nullptr;
+    if(!base) {
+        base = static_cast<char*>(malloc(cap));
+        assert(base);
+    }
+    if(len_ > 0) memcpy(base, Peek(), len_);
+    Free_();
+    base_ = base;
+    cap_ = cap;
+    head_ = 0;
+    mirrored_ = mirrored;
+}
+
+void RingBuffer::Retrieve(size_t len) {
+    assert(len <= len_);
+    len_ -= len;
+    if(len_ == 0) {
+        head_ = 0;
+        return;
+    }
+    head_ += len;
+    if(mirrored_ && head_ >= cap_) head_ -= cap_;
+}
+
+std::string RingBuffer::RetrieveAllToStr() {
+    std::string res(Peek(), len_);
+    RetrieveAll();
+    return res;
+}
+
+void RingBuffer::Append(const char* str, size_t len) {
+    EnsureWriteable(len);
+    memcpy(BeginWrite(), str, len);
+    HasWritten(len);
+}
+
+ssize_t RingBuffer::ReadFd(int fd, int* saveErrno) {
+    EnsureWriteable(MIN_READ);
+    ssize_t len = read(fd, BeginWrite(), WritableBytes());
+    if(len < 0) {
+        *saveErrno = errno;
+    }
+    else {
+        len_ += len;
+    }
+    return len;
+}
+
+ssize_t RingBuffer::WriteFd(int fd, int* saveErrno) {
+    ssize_t len = write(fd, Peek(), len_);
+    if(len < 0) {
+        *saveErrno = errno;
+    }
+    else {
+        Retrieve(len);
+    }
+    return len;
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+/*
+ * @Date         : 2026-10-18
+ * @copyleft Apache 2.0
+ */
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <sys/mman.h>   // memfd_create, mmap
+#include <sys/uio.h>
+#include <unistd.h>     // read, write, ftruncate
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <string>
+#include <string_view>
+#include <assert.h>
+
+/*
+ * RingBuffer: 虚拟内存镜像的环形缓冲区，接口与 Buffer 相同。
+ * 同一个 memfd 被连续映射两次，环尾之后的地址就是环首，可读数据与可写空间总是连续的，
+ * 读写指针回绕时不需要搬移数据，读 socket 也不必经过栈上的临时缓冲区。
+ * 容量按页对齐，只在可写空间不足时换一个更大的环；映射失败时退化为普通的堆内存，写到末尾时先搬移数据。
+ * 每个实例占用两段映射，适合日志队列这类长期存在的缓冲区，不宜给每个连接各建一个。
+ */
+class RingBuffer {
+public:
+    /**
+     * @param capacity 初始容量，向上取整到页大小；映射在第一次写入时才建立
+     */
+    explicit RingBuffer(size_t capacity = 65536);
+    ~RingBuffer();
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    size_t WritableBytes() const { return mirrored_ ? cap_ - len_ : cap_ - head_ - len_; }
+    size_t ReadableBytes() const { return len_; }
+    size_t Capacity() const { return cap_; }
+    /**
+     * 是否为镜像映射（否则为退化的堆内存实现）
+     */
+    bool IsMirrored() const { return mirrored_; }
+
+    const char* Peek() const { return base_ + head_; }
+    void EnsureWriteable(size_t len);
+    void HasWritten(size_t len) {
+        assert(len <= WritableBytes());
+        len_ += len;
+    }
+
+    void Retrieve(size_t len);
+    void RetrieveUntil(const char* end) {
+        assert(Peek() <= end);
+        Retrieve(end - Peek());
+    }
+    void RetrieveAll() {
+        head_ = 0;
+        len_ = 0;
+    }
+    std::string RetrieveAllToStr();
+    /**
+     * 与 Buffer 接口保持一致；镜像映射与实例同生命周期，不在空闲时归还
+     */
+    void Release() {}
+
+    const char* BeginWriteConst() const { return base_ + head_ + len_; }
+    char* BeginWrite() { return base_ + head_ + len_; }
+
+    void Append(const char* str, size_t len);
+    void Append(std::string_view str) { Append(str.data(), str.size()); }
+    void Append(const void* data, size_t len) { Append(static_cast<const char*>(data), len); }
+
+    /**
+     * 从 fd 读取数据，直接读入可写空间；剩余空间少于 MIN_READ 时先扩容
+     * @return 读取字节数，出错返回 -1 并设置 *Errno
+     */
+    ssize_t ReadFd(int fd, int* Errno);
+    /**
+     * 将可读数据写入 fd
+     */
+    ssize_t WriteFd(int fd, int* Errno);
+
+    static const size_t MIN_READ = 4096;
+
+private:
+    /**
+     * 建立容量为 cap 的镜像映射，失败时返回 nullptr
+     */
+    static char* MapMirror_(size_t cap);
+    /**
+     * 释放当前存储
+     */
+    void Free_();
+    /**
+     * 换一个至少能再写入 len 字节的环，可读数据搬到新环的起始处
+     */
+    void Grow_(size_t len);
+
+    char* base_;
+    size_t cap_;
+    size_t initCap_;
+    size_t head_;     /* 可读数据起点相对 base_ 的偏移，镜像时小于 cap_ */
+    size_t len_;      /* 可读字节数 */
+    bool mirrored_;
+};
+
+#endif //RING_BUFFER_H
\ No newline at end of file
@@ -0,0 +1,31 @@
+#include "chunkedwriter.h"
+
+void ChunkedWriter::Write(const char* data, size_t len) {
+    if(len == 0) return;
+    if(chunked_ && chunkLen_ == 0) {
+        buff_.Append("00000000\r\n", SIZE_DIGITS + 2);
+        written_ += SIZE_DIGITS + 2;
+    }
+    buff_.Append(data, len);
+    written_ += len;
+    if(chunked_) chunkLen_ += len;
+}
+
+void ChunkedWriter::Flush() {
+    if(chunkLen_ == 0) return;
+    /* 长度行位于本 chunk 内容之前，缓冲区扩容搬移后按写指针回推定位 */
+    char* size = buff_.BeginWrite() - chunkLen_ - (SIZE_DIGITS + 2);
+    char digits[SIZE_DIGITS + 1];
+    snprintf(digits, sizeof(digits), "%08zx", chunkLen_);
+    memcpy(size, digits, SIZE_DIGITS);
+    buff_.Append("\r\n", 2);
+    written_ += 2;
+    chunkLen_ = 0;
+}
+
+void ChunkedWriter::Finish() {
+    if(!chunked_) return;
+    Flush();
+    buff_.Append("0\r\n\r\n", 5);
+    written_ += 5;
+}
\ No newline at end of file
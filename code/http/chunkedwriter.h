@@ -0,0 +1,62 @@
+/*
+ * @Date         : 2026-10-18
+ * @copyleft Apache 2.0
+ */
+#ifndef CHUNKED_WRITER_H
+#define CHUNKED_WRITER_H
+
+#include <stdio.h>       // snprintf
+#include <string_view>
+#include <functional>
+
+#include "../buffer/buffer.h"
+
+/*
+ * ChunkedWriter: 把分段生成的响应体追加到连接的写缓冲区。
+ * chunked 为 true 时，两次 Flush 之间写入的各段合并成一个 chunk：先预留定长的长度行，
+ * Flush 时回填，处理函数逐行输出也不会每行多出一个长度行；Finish 写入结束块。
+ * chunked 为 false 时（HTTP/1.0 客户端）原样写入，响应体以关闭连接结束。
+ * 写入的字节由 HttpConn 作为一个缓冲区段排入输出队列。
+ */
+class ChunkedWriter {
+public:
+    ChunkedWriter(Buffer& buff, bool chunked): buff_(buff), chunked_(chunked), written_(0), chunkLen_(0) {}
+
+    /**
+     * 追加一段内容到当前 chunk，长度为 0 时忽略
+     */
+    void Write(const char* data, size_t len);
+    void Write(std::string_view data) { Write(data.data(), data.size()); }
+
+    /**
+     * 结束当前 chunk（回填长度行并写入 CRLF），之后的内容进入新的 chunk
+     */
+    void Flush();
+
+    /**
+     * 结束当前 chunk 并写入结束块，之后不能再写
+     */
+    void Finish();
+
+    /**
+     * 本 writer 已向缓冲区追加的字节数（含 chunk 的长度行与 CRLF）
+     */
+    size_t Written() const { return written_; }
+
+private:
+    /* 长度行固定为 8 位十六进制（chunk-size 允许前导 0），内容写完前即可预留 */
+    static const int SIZE_DIGITS = 8;
+
+    Buffer& buff_;
+    bool chunked_;
+    size_t written_;
+    size_t chunkLen_;   /* 当前未结束 chunk 的内容长度，0 表示没有打开的 chunk */
+};
+
+/*
+ * 分段生成响应体的处理函数：每次调用至少向 writer 追加一段内容，或返回 false 表示响应体已全部生成。
+ * 输出队列低于水位时才会被再次调用，可能在连接所在的任一处理线程上执行。
+ */
+typedef std::function<bool(ChunkedWriter&)> BodyGenerator;
+
+#endif //CHUNKED_WRITER_H
\ No newline at end of file
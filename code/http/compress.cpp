@@ -0,0 +1,145 @@
+#include "compress.h"
+
+#include <strings.h>   // strncasecmp
+
+bool Compress::Gzip(std::string_view in, std::string* out, int level) {
+    z_stream zs = {};
+    /* windowBits 加 16 输出 gzip 头尾 */
+    if(deflateInit2(&zs, level, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK) return false;
+    out->resize(deflateBound(&zs, in.size()));
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    zs.avail_in = in.size();
+    zs.next_out = reinterpret_cast<Bytef*>(out->data());
+    zs.avail_out = out->size();
+    int ret = deflate(&zs, Z_FINISH);
+    out->resize(zs.total_out);
+    deflateEnd(&zs);
+    return ret == Z_STREAM_END;
+}
+
+bool Compress::Brotli(std::string_view in, std::string* out, int quality) {
+    size_t len = BrotliEncoderMaxCompressedSize(in.size());
+    if(len == 0) return false;
+    out->resize(len);
+    if(!BrotliEncoderCompress(quality, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_GENERIC,
+                              in.size(), reinterpret_cast<const uint8_t*>(in.data()),
+                              &len, reinterpret_cast<uint8_t*>(out->data()))) {
+        out->clear();
+        return false;
+    }
+    out->resize(len);
+    return true;
+}
+
+bool Compress::IsCompressible(std::string_view mime) {
+    if(mime.starts_with("text/")) return true;
+    static const std::string_view TYPES[] = {
+        "application/javascript", "application/json", "application/xml", "application/xhtml+xml",
+        "application/rtf", "application/vnd.ms-fontobject", "image/svg+xml", "image/x-icon",
+        "font/ttf", "font/otf",
+    };
+    for(std::string_view type : TYPES) {
+        if(mime == type) return true;
+    }
+    return false;
+}
+
+const char* Compress::Name(int encoding) {
+    switch(encoding) {
+    case GZIP: return "gzip";
+    case BR:   return "br";
+    default:   return "";
+    }
+}
+
+static std::string_view Trim(std::string_view str) {
+    while(!str.empty() && (str.front() == ' ' || str.front() == '\t')) str.remove_prefix(1);
+    while(!str.empty() && (str.back() == ' ' || str.back() == '\t')) str.remove_suffix(1);
+    return str;
+}
+
+/* 解析 ";q=0.8" 形式的参数，返回千分制的 q 值；没有 q 参数时为 1000 */
+static int ParseQ(std::string_view params) {
+    while(!params.empty()) {
+        size_t semi = params.find(';');
+        std::string_view param = Trim(params.substr(0, semi));
+        params = semi == std::string_view::npos ? std::string_view() : params.substr(semi + 1);
+        if(param.size() < 3 || (param[0] != 'q' && param[0] != 'Q') || param[1] != '=') continue;
+        param.remove_prefix(2);
+        int q = 0, scale = 1000;
+        bool frac = false;
+        for(char ch : param) {
+            if(ch == '.' && !frac) {
+                frac = true;
+            }
+            else if(ch >= '0' && ch <= '9') {
+                if(!frac) q = q * 10 + (ch - '0') * 1000;
+                else if(scale > 1) q += (ch - '0') * (scale /= 10);
+            }
+            else {
+                return 0;
+            }
+        }
+        return q > 1000 ? 1000 : q;
+    }
+    return 1000;
+}
+
+int Compress::Select(std::string_view accept, unsigned available) {
+    if(!(available & ~(1u << IDENTITY))) return IDENTITY;
+    int q[ENCODING_NUM] = {-1, -1, -1};
+    int any = -1;
+    while(!accept.empty()) {
+        size_t comma = accept.find(',');
+        std::string_view item = accept.substr(0, comma);
+        accept = comma == std::string_view::npos ? std::string_view() : accept.substr(comma + 1);
+        size_t semi = item.find(';');
+        std::string_view name = Trim(item.substr(0, semi));
+        int value = semi == std::string_view::npos ? 1000 : ParseQ(item.substr(semi + 1));
+        if(name.size() == 4 && strncasecmp(name.data(), "gzip", 4) == 0) q[GZIP] = value;
+        else if(name.size() == 6 && strncasecmp(name.data(), "x-gzip", 6) == 0) q[GZIP] = value;
+        else if(name.size() == 2 && strncasecmp(name.data(), "br", 2) == 0) q[BR] = value;
+        else if(name == "*") any = value;
+    }
+    int best = IDENTITY, bestQ = 0;
+    for(int enc : {BR, GZIP}) {
+        if(!(available & (1u << enc))) continue;
+        int value = q[enc] >= 0 ? q[enc] : any;
+        if(value > bestQ) {
+            best = enc;
+            bestQ = value;
+        }
+    }
+    return best;
+}
+
+Deflater* Deflater::ThreadLocal() {
+    static thread_local Deflater inst;
+    return &inst;
+}
+
+Deflater::Deflater(): zs_(), ok_(false) {
+    ok_ = deflateInit2(&zs_, LEVEL, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+}
+
+Deflater::~Deflater() {
+    if(ok_) deflateEnd(&zs_);
+}
+
+bool Deflater::Reset() {
+    return ok_ && deflateReset(&zs_) == Z_OK;
+}
+
+bool Deflater::Write(std::string_view in, bool finish, const std::function<void(const char*, size_t)>& sink) {
+    if(!ok_) return false;
+    zs_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    zs_.avail_in = in.size();
+    do {
+        zs_.next_out = reinterpret_cast<Bytef*>(out_);
+        zs_.avail_out = OUT_SIZE;
+        if(deflate(&zs_, finish ? Z_FINISH : Z_NO_FLUSH) == Z_STREAM_ERROR) return false;
+        size_t len = OUT_SIZE - zs_.avail_out;
+        if(len > 0) sink(out_, len);
+    } while(zs_.avail_out == 0);
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+/*
+ * @Date         : 2026-10-18
+ * @copyleft Apache 2.0
+ */
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <zlib.h>
+#include <brotli/encode.h>
+
+/*
+ * Compress: 静态资源预压缩用的一次性压缩函数。
+ * 在文件载入缓存时调用，结果与缓存条目一起保存、一起失效。
+ */
+class Compress {
+public:
+    /* 内容编码，同时作为 CachedFile::rep 的下标 */
+    enum Encoding {
+        IDENTITY = 0,
+        GZIP,
+        BR,
+        ENCODING_NUM,
+    };
+
+    /**
+     * gzip 格式压缩
+     * @param level zlib 压缩级别 1~9
+     * @return 是否成功
+     */
+    static bool Gzip(std::string_view in, std::string* out, int level = 9);
+
+    /**
+     * brotli 压缩
+     * @param quality 压缩质量 0~11
+     * @return 是否成功
+     */
+    static bool Brotli(std::string_view in, std::string* out, int quality = BROTLI_QUALITY);
+
+    /**
+     * 按 MIME 类型判断内容是否值得压缩（文本、脚本、svg 与未压缩的字体）
+     */
+    static bool IsCompressible(std::string_view mime);
+
+    /**
+     * Content-encoding 的取值，IDENTITY 为空
+     */
+    static const char* Name(int encoding);
+
+    /**
+     * 按 Accept-Encoding 从可用的编码中选出 q 值最高的一个，q 值相同时 br 优先于 gzip
+     * @param accept Accept-Encoding 请求头
+     * @param available 第 i 位为 1 表示编码 i 可用
+     * @return 选中的编码，都不接受时返回 IDENTITY
+     */
+    static int Select(std::string_view accept, unsigned available);
+
+    /* 小于该长度的内容压缩收益抵不上头部与解压开销 */
+    static const size_t MIN_SIZE = 256;
+    /* 超过该长度的文件不做预压缩，避免首次命中时长时间占用线程 */
+    static const size_t MAX_SIZE = 8 << 20;
+    /* 11 级压缩率最高但比 9 级慢一个数量级，首次命中时同步压缩取 9 级 */
+    static const int BROTLI_QUALITY = 9;
+};
+
+/*
+ * Deflater: 动态内容的流式 gzip 压缩器。
+ * 每个压缩线程持有一个，z_stream 在线程生命周期内以 deflateReset 复用，
+ * 不必为每个响应重新分配数百 KB 的压缩状态；输出按固定大小的块交给调用者。
+ */
+class Deflater {
+public:
+    /**
+     * 当前线程的压缩器
+     */
+    static Deflater* ThreadLocal();
+
+    ~Deflater();
+    Deflater(const Deflater&) = delete;
+    Deflater& operator=(const Deflater&) = delete;
+
+    /**
+     * 开始一个新的 gzip 流
+     * @return 压缩状态是否可用
+     */
+    bool Reset();
+
+    /**
+     * 压缩一段输入，输出缓冲区每填满一次（finish 时还有流的结尾）调用一次 sink
+     * @param finish 是否为最后一段输入
+     * @return 是否成功
+     */
+    bool Write(std::string_view in, bool finish, const std::function<void(const char*, size_t)>& sink);
+
+    static const int LEVEL = 6;          /* 动态内容在线压缩，取速度与压缩率的折中 */
+    static const size_t OUT_SIZE = 16384;
+
+private:
+    Deflater();
+
+    z_stream zs_;
+    bool ok_;
+    char out_[OUT_SIZE];
+};
+
+#endif //COMPRESS_H
\ No newline at end of file
@@ -0,0 +1,328 @@
+#include "filecache.h"
+#include "httpresponse.h"
+#include "../pool/threadpool.h"
+
+FileCache::FileCache():
+        watched_(false), compressLane_(nullptr), pendingVariants_(0), shardBudget_(DEFAULT_BUDGET / SHARD_NUM), shardMaxEntries_(DEFAULT_MAX_ENTRIES / SHARD_NUM) {}
+
+FileCache* FileCache::Instance() {
+    static FileCache inst;
+    return &inst;
+}
+
+void FileCache::Init(const char* srcDir, size_t budget, size_t maxEntries, size_t maxFds) {
+    assert(srcDir);
+    srcDir_ = srcDir;
+    shardBudget_ = budget / SHARD_NUM;
+    shardMaxEntries_ = maxEntries / SHARD_NUM > 0 ? maxEntries / SHARD_NUM : 1;
+    shardMaxFds_ = maxFds / SHARD_NUM > 0 ? maxFds / SHARD_NUM : 1;
+    Clear();
+}
+
+CachedFilePtr FileCache::Get(const std::string& path, int* code) {
+    assert(code);
+    int shardIdx = ShardOf_(path);
+    Shard& shard = shards_[shardIdx];
+    bool watched = watched_.load(std::memory_order_relaxed);
+    int64_t now = watched ? 0 : CoarseClock::NowMs();
+    CachedFilePtr cached;
+    uint64_t gen = 0;
+    {
+        std::lock_guard<std::mutex> locker(shard.mtx);
+        auto it = shard.index.find(path);
+        if(it != shard.index.end()) {
+            Slot& slot = *it->second;
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            if(watched || now - slot.checkedMs < CHECK_INTERVAL_MS) {
+                shard.hits++;
+                return slot.file;
+            }
+            cached = slot.file;
+        }
+        gen = shard.gen;
+    }
+
+    /* 未命中或需要校验：文件系统调用都在锁外进行 */
+    struct stat st;
+    if(!Stat_(path, &st, code)) {
+        std::lock_guard<std::mutex> locker(shard.mtx);
+        auto it = shard.index.find(path);
+        if(it != shard.index.end()) Erase_(shard, it->second);
+        return nullptr;
+    }
+    if(cached && cached->mtime == st.st_mtime && cached->ino == st.st_ino
+            && cached->size == static_cast<size_t>(st.st_size)) {
+        std::lock_guard<std::mutex> locker(shard.mtx);
+        auto it = shard.index.find(path);
+        if(it != shard.index.end() && it->second->file == cached) {
+            it->second->checkedMs = now;
+        }
+        shard.hits++;
+        return cached;
+    }
+
+    CachedFilePtr file = Load_(path, shardIdx, code);
+    bool inserted = false;
+    {
+        std::lock_guard<std::mutex> locker(shard.mtx);
+        shard.misses++;
+        if(file && shard.gen == gen) {
+            /* 载入期间分片内有条目失效时不放入缓存，文件可能恰好在 stat 之后被修改 */
+            inserted = Insert_(shard, file, now);
+        }
+    }
+    ThreadPool* lane = compressLane_.load(std::memory_order_acquire);
+    if(inserted && file->compressible && lane) {
+        /* 压缩耗时远超一次请求，交给压缩道，完成前先发送原始内容。调用者是 I/O 线程，
+           压缩道积压时不等待，放弃生成变体，条目被重新载入前一直发送原始内容 */
+        bool queued = pendingVariants_.fetch_add(1, std::memory_order_relaxed) < MAX_PENDING_VARIANTS
+                && lane->TryAddTask([this, file] {
+                    BuildVariants_(file);
+                    pendingVariants_.fetch_sub(1, std::memory_order_relaxed);
+                });
+        if(!queued) {
+            pendingVariants_.fetch_sub(1, std::memory_order_relaxed);
+            LOG_DEBUG("FileCache skip variants of %s, compress lane busy", file->path.data());
+        }
+    }
+    return file;
+}
+
+void FileCache::Clear() {
+    for(Shard& shard : shards_) {
+        std::lock_guard<std::mutex> locker(shard.mtx);
+        shard.index.clear();
+        shard.lru.clear();
+        shard.used = 0;
+        shard.fds = 0;
+        shard.gen++;
+    }
+}
+
+void FileCache::Invalidate(const std::string& path) {
+    Shard& shard = shards_[ShardOf_(path)];
+    std::lock_guard<std::mutex> locker(shard.mtx);
+    shard.gen++;
+    auto it = shard.index.find(path);
+    if(it != shard.index.end()) {
+        LOG_DEBUG("FileCache invalidate %s", path.data());
+        Erase_(shard, it->second);
+    }
+}
+
+void FileCache::InvalidatePrefix(const std::string& prefix) {
+    for(Shard& shard : shards_) {
+        std::lock_guard<std::mutex> locker(shard.mtx);
+        shard.gen++;
+        for(auto it = shard.lru.begin(); it != shard.lru.end(); ) {
+            auto next = std::next(it);
+            if(it->key.compare(0, prefix.size(), prefix) == 0) Erase_(shard, it);
+            it = next;
+        }
+    }
+}
+
+FileCache::Stats FileCache::GetStats() {
+    Stats stats = {0, 0, 0, 0, 0, 0};
+    for(Shard& shard : shards_) {
+        std::lock_guard<std::mutex> locker(shard.mtx);
+        stats.hits += shard.hits;
+        stats.misses += shard.misses;
+        stats.responseHits += shard.responseHits.load(std::memory_order_relaxed);
+        stats.bytesServed += shard.bytesServed.load(std::memory_order_relaxed);
+        stats.entries += shard.index.size();
+        stats.bytesCached += shard.used;
+    }
+    return stats;
+}
+
+void FileCache::ForEach(int shard, const std::function<void(const CachedFile&)>& fn) {
+    assert(shard >= 0 && shard < SHARD_NUM);
+    std::lock_guard<std::mutex> locker(shards_[shard].mtx);
+    for(const Slot& slot : shards_[shard].lru) {
+        fn(*slot.file);
+    }
+}
+
+bool FileCache::Stat_(const std::string& path, struct stat* st, int* code) const {
+    if(stat((srcDir_ + path).data(), st) < 0 || !S_ISREG(st->st_mode)) {
+        *code = 404;
+        return false;
+    }
+    if(!(st->st_mode & S_IROTH)) {
+        *code = 403;
+        return false;
+    }
+    return true;
+}
+
+/* 从头读入 size 字节 */
+static bool ReadAll(int fd, size_t size, std::string* out) {
+    out->resize(size);
+    size_t done = 0;
+    while(done < size) {
+        ssize_t len = pread(fd, &(*out)[done], size - done, done);
+        if(len <= 0) break;
+        done += len;
+    }
+    return done == size;
+}
+
+CachedFilePtr FileCache::Load_(const std::string& path, int shard, int* code) const {
+    int fd = open((srcDir_ + path).data(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0) {
+        *code = 404;
+        return nullptr;
+    }
+    /* 元数据取自已打开的描述符：stat 与 open 之间文件可能被替换，ETag 与长度要和发送的内容一致 */
+    struct stat st;
+    if(fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        *code = 404;
+        return nullptr;
+    }
+    std::shared_ptr<CachedFile> file = std::make_shared<CachedFile>();
+    file->path = path;
+    file->shard = shard;
+    file->size = st.st_size;
+    file->mtime = st.st_mtime;
+    file->ino = st.st_ino;
+    HttpResponse::MimeType mime = HttpResponse::GetFileType(path);
+    file->mime = mime.type;
+    file->mimeLine = mime.line;
+    file->compressible = Compress::IsCompressible(file->mime)
+            && file->size >= Compress::MIN_SIZE && file->size <= Compress::MAX_SIZE;
+    if(file->size >= SENDFILE_MIN) {
+        file->fd = fd;
+    }
+    else {
+        bool ok = ReadAll(fd, file->size, &file->data);
+        close(fd);
+        if(!ok) {
+            LOG_WARN("Read %s failed", path.data());
+            *code = 404;
+            return nullptr;
+        }
+    }
+    /* 与 nginx 相同由 mtime 与长度生成 ETag；mtime 只精确到秒，
+       载入时文件在最近 1 秒内被修改过则同一秒内可能再变，只给弱标签 */
+    file->weak = CoarseClock::Now() - st.st_mtime < 1;
+    BuildReps_(file);
+    LOG_DEBUG("FileCache load %s, %zu bytes", path.data(), file->size);
+    return file;
+}
+
+void FileCache::BuildVariants_(const CachedFilePtr& old) {
+    std::shared_ptr<CachedFile> file = std::make_shared<CachedFile>();
+    file->path = old->path;
+    file->data = old->data;
+    file->size = old->size;
+    file->mtime = old->mtime;
+    file->ino = old->ino;
+    file->mime = old->mime;
+    file->mimeLine = old->mimeLine;
+    file->compressible = true;
+    file->weak = old->weak;
+    file->shard = old->shard;
+    std::string content;  /* 大文件临时读入的内容，只用于压缩 */
+    if(old->fd >= 0) {
+        /* 新旧条目各自持有描述符，旧条目被替换后可能仍在发送中 */
+        file->fd = fcntl(old->fd, F_DUPFD_CLOEXEC, 0);
+        if(file->fd < 0 || !ReadAll(file->fd, file->size, &content)) {
+            LOG_WARN("Read %s for compression failed", file->path.data());
+            return;
+        }
+    }
+    /* 压缩后没有明显变小的编码不保留 */
+    std::string_view src = file->fd < 0 ? std::string_view(file->data) : std::string_view(content);
+    for(int enc : {Compress::GZIP, Compress::BR}) {
+        std::string& body = file->rep[enc].body;
+        bool done = enc == Compress::GZIP ? Compress::Gzip(src, &body) : Compress::Brotli(src, &body);
+        if(done && body.size() < file->size / 10 * 9) {
+            file->encodings |= 1u << enc;
+        }
+        else {
+            body = std::string();
+        }
+    }
+    if(file->encodings == 1u << Compress::IDENTITY) return;
+    BuildReps_(file);
+    LOG_DEBUG("FileCache compress %s, gzip %zu, br %zu", file->path.data(),
+              file->rep[Compress::GZIP].body.size(), file->rep[Compress::BR].body.size());
+
+    Shard& shard = shards_[file->shard];
+    std::lock_guard<std::mutex> locker(shard.mtx);
+    auto it = shard.index.find(file->path);
+    /* 压缩期间条目已失效或被重新载入时丢弃结果 */
+    if(it != shard.index.end() && it->second->file == old) {
+        Insert_(shard, file, it->second->checkedMs);
+    }
+}
+
+void FileCache::BuildReps_(const std::shared_ptr<CachedFile>& file) {
+    const char* weak = file->weak ? "W/" : "";
+    char date[64];
+    struct tm tm;
+    gmtime_r(&file->mtime, &tm);
+    strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    for(int enc = 0; enc < Compress::ENCODING_NUM; enc++) {
+        if(!(file->encodings & (1u << enc))) continue;
+        CachedFile::Rep& rep = file->rep[enc];
+        /* 同一文件的不同编码是不同的表示，ETag 带上编码后缀以免缓存混用 */
+        char etag[80];
+        snprintf(etag, sizeof(etag), "%s\"%llx-%zx%s%s\"", weak, static_cast<unsigned long long>(file->mtime),
+                 file->size, enc != Compress::IDENTITY ? "-" : "", Compress::Name(enc));
+        rep.etag = etag;
+        rep.validators = "ETag: " + rep.etag + "\r\nLast-modified: " + date + "\r\n";
+        rep.header = file->mimeLine;
+        if(enc != Compress::IDENTITY) {
+            rep.header += std::string("Content-encoding: ") + Compress::Name(enc) + "\r\n";
+        }
+        if(file->compressible) {
+            /* 变体生成前后原始内容的响应头保持一致 */
+            rep.header += "Vary: Accept-Encoding\r\n";
+        }
+        rep.header += "Content-length: " + std::to_string(file->Size(enc)) + "\r\n\r\n";
+        if(file->Body(enc) && file->Size(enc) < SENDFILE_MIN) {
+            /* 内容较小的 200 响应每次都相同，预先拼好，命中时一次写出 */
+            rep.response[0] = HttpResponse::Preserialize(file, enc, false);
+            rep.response[1] = HttpResponse::Preserialize(file, enc, true);
+        }
+    }
+}
+
+bool FileCache::Insert_(Shard& shard, const CachedFilePtr& file, int64_t now) {
+    auto it = shard.index.find(file->path);
+    if(it != shard.index.end()) Erase_(shard, it->second);
+
+    size_t charge = sizeof(CachedFile) + file->path.size() + file->data.size();
+    for(const CachedFile::Rep& rep : file->rep) {
+        charge += rep.body.size() + rep.etag.size() + rep.validators.size() + rep.header.size()
+                + rep.response[0].size() + rep.response[1].size();
+    }
+    if(charge > shardBudget_) {
+        /* 单个文件超过分片预算时不缓存，只交给本次请求使用 */
+        return false;
+    }
+    shard.lru.push_front(Slot{file->path, file, charge, now});
+    shard.index.emplace(shard.lru.front().key, shard.lru.begin());
+    shard.used += charge;
+    if(file->fd >= 0) shard.fds++;
+    while(shard.used > shardBudget_ || shard.index.size() > shardMaxEntries_) {
+        Erase_(shard, std::prev(shard.lru.end()));
+    }
+    /* 持有 fd 的条目超过配额时淘汰其中最久未用的，刚放入的条目在链表头部，循环一定会结束 */
+    while(shard.fds > shardMaxFds_) {
+        auto victim = std::prev(shard.lru.end());
+        while(victim->file->fd < 0) --victim;
+        Erase_(shard, victim);
+    }
+    return true;
+}
+
+void FileCache::Erase_(Shard& shard, std::list<Slot>::iterator it) {
+    shard.used -= it->charge;
+    if(it->file->fd >= 0) shard.fds--;
+    shard.index.erase(it->key);
+    shard.lru.erase(it);
+}
\ No newline at end of file
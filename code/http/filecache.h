@@ -0,0 +1,239 @@
+/*
+ * @Date         : 2026-10-18
+ * @copyleft Apache 2.0
+ */
+#ifndef FILE_CACHE_H
+#define FILE_CACHE_H
+
+#include <fcntl.h>       // open
+#include <unistd.h>      // close, pread
+#include <sys/stat.h>    // stat
+#include <time.h>        // gmtime_r, strftime
+#include <string>
+#include <string_view>
+#include <list>
+#include <functional>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+#include "../log/log.h"
+#include "../timer/coarseclock.h"
+#include "compress.h"
+
+class ThreadPool;
+
+/*
+ * 缓存中的一个静态文件。创建后只读，可被多个连接同时引用；
+ * 被淘汰后由最后一个持有者释放（关闭 fd）。
+ */
+struct CachedFile {
+    /* 文件的一种表示：原始内容或某种预压缩编码，各自有独立的 ETag 与头部 */
+    struct Rep {
+        std::string body;        /* 压缩后的内容；IDENTITY 为空，内容见 data / fd */
+        std::string etag;        /* 实体标签（含引号，弱标签带 W/ 前缀） */
+        std::string validators;  /* 预先生成的 "ETag: ...\r\nLast-modified: ...\r\n" */
+        std::string header;      /* 预先生成的 Content-type、Content-encoding、Vary 与 Content-length，以空行结尾 */
+        std::string response[2]; /* 内容较小时 200 响应状态行与 Date 之后的部分（头部、内容），下标为是否长连接；否则为空 */
+    };
+
+    std::string path;     /* 规范化后的请求路径（相对资源根目录） */
+    std::string data;     /* 小文件的全部内容 */
+    int fd;               /* 大文件保留的只读描述符，通过 sendfile 发送；小文件为 -1 */
+    size_t size;
+    time_t mtime;
+    ino_t ino;
+    std::string_view mime;      /* 指向静态 MIME 表 */
+    std::string_view mimeLine;  /* 完整的 "Content-type: ...\r\n" 头部行 */
+    Rep rep[Compress::ENCODING_NUM];  /* 下标为 Compress::Encoding */
+    unsigned encodings;   /* 第 i 位为 1 表示 rep[i] 可用，IDENTITY 总是可用 */
+    bool compressible;    /* 可以有预压缩变体；变体在后台生成，完成后以新条目替换只有原始内容的条目 */
+    bool weak;            /* ETag 是否为弱标签 */
+    int shard;            /* 所在分片，用于统计 */
+
+    CachedFile(): fd(-1), size(0), mtime(0), ino(0), encodings(1u << Compress::IDENTITY),
+                  compressible(false), weak(false), shard(0) {}
+    ~CachedFile() { if(fd >= 0) close(fd); }
+    CachedFile(const CachedFile&) = delete;
+    CachedFile& operator=(const CachedFile&) = delete;
+
+    /**
+     * 编码 enc 的内容在内存中的起始地址，需要用 sendfile 发送（大文件的原始内容）时为空
+     */
+    const char* Body(int enc) const {
+        if(enc != Compress::IDENTITY) return rep[enc].body.data();
+        return fd < 0 ? data.data() : nullptr;
+    }
+    /**
+     * 编码 enc 的内容长度
+     */
+    size_t Size(int enc) const {
+        return enc != Compress::IDENTITY ? rep[enc].body.size() : size;
+    }
+    /**
+     * 编码 enc 是否有预先序列化的完整响应
+     */
+    bool HasResponse(int enc) const { return !rep[enc].response[0].empty(); }
+};
+
+typedef std::shared_ptr<const CachedFile> CachedFilePtr;
+
+/*
+ * FileCache: 静态资源的打开文件与元数据缓存。
+ * 按路径哈希分片，每个分片独立加锁并维护自己的 LRU 链表与内存预算；
+ * 命中时不做任何文件系统调用：由 FileWatcher 监视目录时靠 inotify 事件失效条目，
+ * 否则超过 CHECK_INTERVAL_MS 未校验的条目才重新 stat 一次。
+ * 条目以引用计数共享，淘汰只是移出索引，正在发送的响应仍持有原文件。
+ */
+class FileCache {
+public:
+    static FileCache* Instance();
+
+    /**
+     * 设置资源根目录与容量，启动时调用一次
+     * @param srcDir 资源根目录（以 '/' 结尾）
+     * @param budget 全部分片缓存的文件内容总字节数上限
+     * @param maxEntries 条目数上限
+     * @param maxFds 持有 fd 的大文件条目数上限，超过时淘汰其中最久未用的
+     */
+    void Init(const char* srcDir, size_t budget = DEFAULT_BUDGET, size_t maxEntries = DEFAULT_MAX_ENTRIES,
+              size_t maxFds = DEFAULT_MAX_FDS);
+
+    /**
+     * 获取文件
+     * @param path 规范化后的请求路径（如 "/index.html"）
+     * @param code 失败时写入 404（不存在或不是普通文件）或 403（无读权限）
+     * @return 文件，失败返回空
+     */
+    CachedFilePtr Get(const std::string& path, int* code);
+
+    /**
+     * 丢弃全部缓存条目
+     */
+    void Clear();
+
+    /**
+     * 文件被修改、移动或删除时使对应条目失效
+     */
+    void Invalidate(const std::string& path);
+    /**
+     * 使路径以 prefix 开头的全部条目失效（目录被移动或删除）
+     */
+    void InvalidatePrefix(const std::string& prefix);
+
+    /**
+     * 是否由 inotify 负责失效；为 true 时命中路径不再定期 stat 校验
+     */
+    void SetWatched(bool watched) { watched_.store(watched, std::memory_order_relaxed); }
+
+    /**
+     * 设置生成预压缩变体的线程池（压缩道）。为空时不生成变体，只发送原始内容；
+     * 压缩道已满或排队的变体任务达到 MAX_PENDING_VARIANTS 时放弃生成，同样只发送原始内容
+     */
+    void SetCompressLane(ThreadPool* lane) { compressLane_.store(lane, std::memory_order_release); }
+
+    /**
+     * 记录一次由缓存文件发送的响应
+     * @param bytes 来自缓存的字节数（完整响应或文件内容）
+     * @param preserialized 是否直接发送预先序列化的完整响应
+     */
+    void CountServed(const CachedFile& file, size_t bytes, bool preserialized) {
+        Shard& shard = shards_[file.shard];
+        shard.bytesServed.fetch_add(bytes, std::memory_order_relaxed);
+        if(preserialized) shard.responseHits.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    struct Stats {
+        uint64_t hits;          /* Get 命中次数 */
+        uint64_t misses;        /* Get 未命中（含需要重新载入）次数 */
+        uint64_t responseHits;  /* 直接发送完整响应的次数 */
+        uint64_t bytesServed;   /* 从缓存发送的字节数 */
+        size_t entries;
+        size_t bytesCached;
+    };
+
+    /**
+     * 汇总各分片的计数器
+     */
+    Stats GetStats();
+
+    /**
+     * 在分片锁内依次访问分片中的条目（从最近使用开始），fn 中不能再访问缓存
+     * @param shard 分片下标，0 到 SHARD_NUM - 1
+     */
+    void ForEach(int shard, const std::function<void(const CachedFile&)>& fn);
+
+    static const int SHARD_NUM = 16;
+    /* 不小于该长度的文件保留 fd 走 sendfile，更小的文件读入内存与响应头合并发送 */
+    static const size_t SENDFILE_MIN = 16384;
+    static const size_t DEFAULT_BUDGET = 64 << 20;
+    static const size_t DEFAULT_MAX_ENTRIES = 1024;
+    static const size_t DEFAULT_MAX_FDS = 256;
+    static const int CHECK_INTERVAL_MS = 1000;
+    static const int MAX_PENDING_VARIANTS = 64;   /* 排队与执行中的变体任务上限，压缩道的其余容量留给动态内容 */
+
+private:
+    FileCache();
+    ~FileCache() = default;
+
+    struct Slot {
+        std::string key;
+        CachedFilePtr file;
+        size_t charge;        /* 计入预算的字节数 */
+        int64_t checkedMs;    /* 上次与磁盘校验的时间 */
+    };
+
+    /* 一个分片：LRU 链表头部为最近使用，索引的 key 指向链表节点中的字符串。各分片独占缓存行 */
+    struct alignas(64) Shard {
+        std::mutex mtx;
+        std::list<Slot> lru;
+        std::unordered_map<std::string_view, std::list<Slot>::iterator> index;
+        size_t used = 0;
+        size_t fds = 0;         /* 持有 fd 的条目数 */
+        uint64_t gen = 0;       /* 每次失效加一，防止失效前开始的载入把旧内容放回缓存 */
+        uint64_t hits = 0;      /* 以下两项受 mtx 保护 */
+        uint64_t misses = 0;
+        std::atomic<uint64_t> responseHits{0};
+        std::atomic<uint64_t> bytesServed{0};
+    };
+
+    /**
+     * 从磁盘加载文件并生成元数据（取自打开后的 fstat），只含原始内容，压缩变体由 BuildVariants_ 在压缩道中生成
+     * @return 文件，失败返回空并写入 code
+     */
+    CachedFilePtr Load_(const std::string& path, int shard, int* code) const;
+    /**
+     * 为 old 生成 gzip / br 变体，old 仍在缓存中时以带变体的新条目替换它
+     */
+    void BuildVariants_(const CachedFilePtr& old);
+    /**
+     * 为 encodings 中的每种编码生成 ETag、头部与预先序列化的响应
+     */
+    static void BuildReps_(const std::shared_ptr<CachedFile>& file);
+    /**
+     * stat 文件并判断是否可以作为静态资源发送
+     */
+    bool Stat_(const std::string& path, struct stat* st, int* code) const;
+    /**
+     * 插入（或替换）条目并按预算淘汰尾部
+     * @return 是否放入了缓存（超过分片预算的文件不缓存）
+     */
+    bool Insert_(Shard& shard, const CachedFilePtr& file, int64_t now);
+    void Erase_(Shard& shard, std::list<Slot>::iterator it);
+
+    int ShardOf_(std::string_view path) const {
+        return static_cast<int>(std::hash<std::string_view>()(path) % SHARD_NUM);
+    }
+
+    std::string srcDir_;
+    std::atomic<bool> watched_;
+    std::atomic<ThreadPool*> compressLane_;
+    std::atomic<int> pendingVariants_;
+    size_t shardBudget_;
+    size_t shardMaxEntries_;
+    size_t shardMaxFds_;
+    Shard shards_[SHARD_NUM];
+};
+
+#endif //FILE_CACHE_H
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "filewatcher.h"
+
+FileWatcher::FileWatcher(): fd_(-1) {}
+
+FileWatcher::~FileWatcher() {
+    if(fd_ >= 0) close(fd_);
+}
+
+bool FileWatcher::Init(const char* srcDir) {
+    assert(srcDir);
+    srcDir_ = srcDir;
+    if(!srcDir_.empty() && srcDir_.back() == '/') srcDir_.pop_back();
+    fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(fd_ < 0) {
+        LOG_WARN("inotify init failed, errno: %d", errno);
+        return false;
+    }
+    if(!AddDir_("")) {
+        close(fd_);
+        fd_ = -1;
+        dirs_.clear();
+        return false;
+    }
+    return true;
+}
+
+bool FileWatcher::AddDir_(const std::string& dir) {
+    std::string full = srcDir_ + dir;
+    int wd = inotify_add_watch(fd_, full.data(), WATCH_MASK | IN_ONLYDIR);
+    if(wd < 0) {
+        LOG_WARN("inotify watch %s failed, errno: %d", full.data(), errno);
+        return false;
+    }
+    dirs_[wd] = dir;
+
+    DIR* dp = opendir(full.data());
+    if(!dp) return true;
+    bool ok = true;
+    while(dirent* entry = readdir(dp)) {
+        if(entry->d_type != DT_DIR || strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        ok = AddDir_(dir + "/" + entry->d_name) && ok;
+    }
+    closedir(dp);
+    return ok;
+}
+
+void FileWatcher::OnEvent() {
+    alignas(struct inotify_event) char buff[16384];
+    while(true) {
+        ssize_t len = read(fd_, buff, sizeof(buff));
+        if(len <= 0) break;
+        for(char* p = buff; p < buff + len; ) {
+            const struct inotify_event* ev = reinterpret_cast<const struct inotify_event*>(p);
+            Handle_(ev);
+            p += sizeof(struct inotify_event) + ev->len;
+        }
+    }
+}
+
+void FileWatcher::Handle_(const struct inotify_event* ev) {
+    if(ev->mask & IN_Q_OVERFLOW) {
+        /* 事件丢失，无法知道哪些文件变了，整个缓存作废 */
+        LOG_WARN("inotify queue overflow, clear file cache");
+        FileCache::Instance()->Clear();
+        return;
+    }
+    auto it = dirs_.find(ev->wd);
+    if(it == dirs_.end()) return;
+    if(ev->mask & IN_IGNORED) {
+        dirs_.erase(it);
+        return;
+    }
+    if(ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+        if(it->second.empty()) {
+            /* 资源根目录本身被移走或删除，无法继续监视，缓存退回定期 stat 校验 */
+            LOG_WARN("srcDir %s moved or deleted, stop watching", srcDir_.data());
+            FileCache::Instance()->SetWatched(false);
+            FileCache::Instance()->Clear();
+        }
+        return;
+    }
+    if(ev->len == 0) return;
+
+    std::string path = it->second + "/" + ev->name;
+    if(ev->mask & IN_ISDIR) {
+        /* 目录被移走或删除时其下的条目都失效；新建或移入的目录需要补上监视 */
+        FileCache::Instance()->InvalidatePrefix(path + "/");
+        if(ev->mask & (IN_MOVED_FROM | IN_DELETE)) RemoveDir_(path);
+        if(ev->mask & (IN_CREATE | IN_MOVED_TO)) AddDir_(path);
+        return;
+    }
+    LOG_DEBUG("inotify %s, mask: %x", path.data(), ev->mask);
+    FileCache::Instance()->Invalidate(path);
+}
+
+void FileWatcher::RemoveDir_(const std::string& dir) {
+    /* watch 跟随目录 inode，移动后旧的相对路径失效，移除它及子目录的 watch，由新位置的 IN_MOVED_TO 重新添加 */
+    std::string prefix = dir + "/";
+    for(auto it = dirs_.begin(); it != dirs_.end(); ) {
+        if(it->second == dir || it->second.compare(0, prefix.size(), prefix) == 0) {
+            inotify_rm_watch(fd_, it->first);
+            it = dirs_.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+/*
+ * @Date         : 2026-10-18
+ * @copyleft Apache 2.0
+ */
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <sys/inotify.h>
+#include <dirent.h>      // opendir
+#include <unistd.h>      // read, close
+#include <errno.h>
+#include <string>
+#include <unordered_map>
+
+#include "../log/log.h"
+#include "filecache.h"
+
+/*
+ * FileWatcher: 用 inotify 监视资源目录树，文件被修改、移动或删除时使对应的 FileCache 条目失效。
+ * inotify fd 为非阻塞，由某个 Reactor 注册到自己的 Poller，可读时调用 OnEvent，
+ * 缓存命中路径因此无需再 stat 校验。
+ */
+class FileWatcher {
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    /**
+     * 递归监视资源目录
+     * @param srcDir 资源根目录（以 '/' 结尾）
+     * @return 是否成功（inotify 不可用时返回 false，缓存退回定期 stat 校验）
+     */
+    bool Init(const char* srcDir);
+
+    /**
+     * inotify fd，可读时调用 OnEvent
+     */
+    int GetFd() const { return fd_; }
+
+    /**
+     * 读取并处理全部待处理事件
+     */
+    void OnEvent();
+
+private:
+    /**
+     * 监视目录及其全部子目录
+     * @param dir 相对资源根目录的路径，根目录为 ""
+     */
+    bool AddDir_(const std::string& dir);
+    /**
+     * 取消目录及其全部子目录的监视
+     */
+    void RemoveDir_(const std::string& dir);
+    void Handle_(const struct inotify_event* ev);
+
+    static const uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_MODIFY | IN_ATTRIB | IN_CREATE | IN_DELETE |
+                                       IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+
+    int fd_;
+    std::string srcDir_;
+    std::unordered_map<int, std::string> dirs_;  /* watch descriptor -> 相对目录 */
+};
+
+#endif //FILE_WATCHER_H
\ No newline at end of file
@@ -3,11 +3,18 @@
 const char* HttpConn::srcDir;
 std::atomic<int> HttpConn::userCount;
 bool HttpConn::isET;
+HttpConn::Handler HttpConn::handler;
 
 HttpConn::HttpConn() {
     fd_ = -1;
     addr_ = {0};
+    gen_ = 0;
     isClose_ = true;
+    keepAlive_ = false;
+    toWrite_ = 0;
+    outHead_ = 0;
+    parseOk_ = false;
+    chunked_ = false;
 }
 
 HttpConn::~HttpConn() {
@@ -19,9 +26,14 @@ void HttpConn::init(int fd, const sockaddr_in& addr) {
     userCount++;
     addr_ = addr;
     fd_ = fd;
+    keepAlive_ = true;
+    generator_ = nullptr;
+    ClearQueue_();
     writeBuff_.RetrieveAll();
     readBuff_.RetrieveAll();
+    request_.Init();
     isClose_ = false;
+    gen_.fetch_add(1, std::memory_order_release);
     LOG_INFO("Client[%d](%s:%d) in, usercount: %d", fd_, GetIP(), GetPort(), (int)userCount);
 }
 
@@ -36,32 +48,51 @@ ssize_t HttpConn::read(int* saveErrno) {
 
 ssize_t HttpConn::write(int* saveErrno) {
     ssize_t len = -1;
+    bool more = false;
+    size_t sent = 0;
     do {
-        len = writev(fd_, iov_, iovCnt_);
+        if(toWrite_ == 0) return 0;
+        const OutSeg& head = outQueue_[outHead_];
+        if(head.file && !head.data) {
+            /* 文件内容由内核直接从页缓存发送，EAGAIN 后从 head.off 处续传；显式偏移不改变共享 fd 的文件位置 */
+            off_t off = head.off;
+            size_t chunk = head.len < WRITE_BUDGET - sent ? head.len : WRITE_BUDGET - sent;
+            len = sendfile(fd_, head.file->fd, &off, chunk);
+            more = false;
+        }
+        else {
+            /* 队列中已排队的响应头与小文件一次写出，紧跟大文件时加 MSG_MORE 与其合并 */
+            struct iovec iov[MAX_IOV];
+            struct msghdr msg;
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = iov;
+            msg.msg_iovlen = FillIov_(iov, &more);
+            len = sendmsg(fd_, &msg, more ? MSG_MORE : 0);
+        }
         if(len <= 0) {
-            *saveErrno = errno;
+            /* sendfile 返回 0 说明文件在发送途中被截断，按出错关闭连接 */
+            *saveErrno = len < 0 ? errno : EIO;
             break;
         }
-        if(iov_[0].iov_len + iov_[1].iov_len == 0) break;
-        else if(static_cast<size_t>(len) > iov_[0].iov_len) {
-            iov_[1].iov_base = (uint8_t*) iov_[1].iov_base + (len - iov_[0].iov_len);
-            iov_[1].iov_len -= (len - iov_[0].iov_len);
-            if(iov_[0].iov_len) {
-                writeBuff_.RetrieveAll();
-                iov_[0].iov_len = 0;
-            }
-        }
-        else {
-            iov_[0].iov_base = (uint8_t*) iov_[0].iov_base + len;
-            iov_[0].iov_len -= len;
-            writeBuff_.Retrieve(len);
+        Consume_(len);
+        sent += len;
+        if(generator_ && toWrite_ < GEN_LOW_WATER) {
+            /* 已生成的内容快发完时再生成下一批；处理函数未结束时 toWrite_ 总大于 0 */
+            Generate_();
         }
-    }while(isET || ToWriteBytes() > 10240);
+        /* 本轮发送量达到 WRITE_BUDGET 后让出线程，剩余部分等下一次 EPOLLOUT，大文件下载不会独占线程 */
+    }while(toWrite_ > 0 && sent < WRITE_BUDGET && (isET || more || ToWriteBytes() > 10240));
     return len;
 }
 
 void HttpConn::Close() {
-    response_.UnmapFile();
+    response_.CloseFile();
+    generator_ = nullptr;
+    ClearQueue_();
+    writeBuff_.RetrieveAll();
+    writeBuff_.Release();
+    readBuff_.RetrieveAll();
+    readBuff_.Release();
     if(isClose_ == false) {
         isClose_ = true;
         userCount--;
@@ -86,29 +117,202 @@ sockaddr_in HttpConn::GetAddr() const {
     return addr_;
 }
 
-bool HttpConn::process() {
-    request_.Init();
+void HttpConn::ReleaseBuffers() {
+    /* 半个请求还在读缓冲区时保留，解析进度以其中的偏移记录 */
+    if(toWrite_ == 0) writeBuff_.Release();
+    readBuff_.Release();
+}
+
+bool HttpConn::Parse() {
     if(readBuff_.ReadableBytes() <= 0) {
         return false;
     }
-    else if(request_.parse(readBuff_)) {
+    HttpRequest::HTTP_CODE ret = request_.parse(readBuff_);
+    if(ret == HttpRequest::NO_REQUEST) {
+        /* 请求尚不完整，解析进度保存在 request_ 中，等待更多数据 */
+        return false;
+    }
+    parseOk_ = (ret == HttpRequest::GET_REQUEST);
+    return true;
+}
+
+void HttpConn::Respond() {
+    if(parseOk_) {
+        request_.Verify();
         LOG_DEBUG("%s", request_.path().c_str());
-        response_.Init(srcDir, request_.path(), IsKeepAlive(), 200);
+        keepAlive_ = request_.IsKeepAlive();
+        HttpResponse::RequestHeaders headers;
+        headers.range = request_.GetHeader(HttpHeader::RANGE);
+        headers.ifRange = request_.GetHeader(HttpHeader::IF_RANGE);
+        headers.ifNoneMatch = request_.GetHeader(HttpHeader::IF_NONE_MATCH);
+        headers.ifModifiedSince = request_.GetHeader(HttpHeader::IF_MODIFIED_SINCE);
+        headers.acceptEncoding = request_.GetHeader(HttpHeader::ACCEPT_ENCODING);
+        headers.version = request_.version();
+        response_.Init(request_.path(), keepAlive_, 200, headers);
+        if(handler) {
+            /* 动态内容由外部设置的处理函数决定，可为请求设置分段生成的响应体 */
+            handler(request_, response_);
+        }
     }
     else {
-        response_.Init(srcDir, request_.path(), false, 400);
+        /* 报文错误后无法确定下一个请求的起点，回复 400 后关闭连接 */
+        keepAlive_ = false;
+        response_.Init(request_.path(), false, 400);
     }
 
+    size_t before = writeBuff_.ReadableBytes();
     response_.MakeResponse(writeBuff_);
-    iov_[0].iov_base = const_cast<char*>(writeBuff_.Peek());
-    iov_[0].iov_len = writeBuff_.ReadableBytes();
-    iovCnt_ = 1;
-
-    if(response_.FileLen() > 0 && response_.File()) {
-        iov_[1].iov_base = response_.File();
-        iov_[1].iov_len = response_.FileLen();
-        iovCnt_ = 2;
+    size_t fileLen = response_.FileLen();
+    if(response_.IsPreserialized()) {
+        /* 命中响应缓存：状态行与 Date 在缓冲区中，其余部分不拷贝，直接引用缓存中的字节 */
+        const std::string& full = response_.FullResponse();
+        FileCache::Instance()->CountServed(*response_.File(), full.size(), true);
+        PushBuff_(writeBuff_.ReadableBytes() - before);
+        PushFile_(response_.ReleaseFile(), full.data(), 0, full.size());
     }
-    LOG_DEBUG("filesize:%d, %d to %d", response_.FileLen(), iovCnt_, ToWriteBytes());
-    return true;
+    else {
+        PushBuff_(writeBuff_.ReadableBytes() - before);
+        if(fileLen > 0) {
+            const char* data = response_.File()->Body(response_.Encoding());
+            CachedFilePtr file = response_.ReleaseFile();
+            if(response_.Ranges().empty()) {
+                FileCache::Instance()->CountServed(*file, fileLen, false);
+                PushFile_(std::move(file), data, 0, fileLen);
+            }
+            else {
+                /* 206：只排入请求的区间，多区间时各分段头部插在对应内容之前 */
+                size_t rangeLen = 0;
+                for(const HttpResponse::ByteRange& r : response_.Ranges()) {
+                    writeBuff_.Append(r.head);
+                    PushBuff_(r.head.size());
+                    PushFile_(file, data, r.off, r.len);
+                    rangeLen += r.len;
+                }
+                writeBuff_.Append(response_.RangeTail());
+                PushBuff_(response_.RangeTail().size());
+                FileCache::Instance()->CountServed(*file, rangeLen, false);
+            }
+        }
+    }
+    if(response_.HasGenerator()) {
+        /* 第一批内容与头部一起排队，随首次 writev 发出，其余的随发送进度生成 */
+        keepAlive_ = response_.IsKeepAlive();
+        chunked_ = response_.IsChunked();
+        generator_ = response_.TakeGenerator();
+        Generate_();
+    }
+    LOG_DEBUG("filesize:%zu, %zu segs to %zu", fileLen, outQueue_.size() - outHead_, ToWriteBytes());
+}
+
+void HttpConn::Reject() {
+    keepAlive_ = false;
+    response_.Init(request_.path(), false, 503);
+    size_t before = writeBuff_.ReadableBytes();
+    response_.MakeResponse(writeBuff_);
+    PushBuff_(writeBuff_.ReadableBytes() - before);
+}
+
+void HttpConn::CompressBody() {
+    std::string body = response_.TakeBody();
+    Deflater* deflater = Deflater::ThreadLocal();
+    ChunkedWriter writer(writeBuff_, true);
+    /* 压缩器每填满一块输出就写成一个 chunk，不需要另存完整的压缩结果 */
+    bool ok = deflater->Reset() && deflater->Write(body, true, [&writer](const char* data, size_t len) {
+        writer.Write(data, len);
+        writer.Flush();
+    });
+    if(ok) {
+        writer.Finish();
+    }
+    else {
+        /* 头部已声明 gzip，无法改回明文：不发送结束块并关闭连接，客户端据此判断响应不完整 */
+        LOG_ERROR("Client[%d] deflate failed", fd_);
+        keepAlive_ = false;
+    }
+    PushBuff_(writer.Written());
+    LOG_DEBUG("Client[%d] deflate %zu bytes, %zu to write", fd_, body.size(), ToWriteBytes());
+}
+
+void HttpConn::Generate_() {
+    ChunkedWriter writer(writeBuff_, chunked_);
+    while(generator_ && writer.Written() < GEN_HIGH_WATER) {
+        if(!generator_(writer)) {
+            writer.Finish();
+            generator_ = nullptr;
+        }
+    }
+    /* 本批内容合成一个 chunk */
+    writer.Flush();
+    PushBuff_(writer.Written());
+}
+
+void HttpConn::PushBuff_(size_t len) {
+    if(len == 0) return;
+    toWrite_ += len;
+    if(outQueue_.size() > outHead_ && !outQueue_.back().file) {
+        outQueue_.back().len += len;
+        return;
+    }
+    outQueue_.push_back(OutSeg{nullptr, nullptr, 0, len});
+}
+
+void HttpConn::PushFile_(CachedFilePtr file, const char* data, size_t off, size_t len) {
+    assert(file);
+    toWrite_ += len;
+    outQueue_.push_back(OutSeg{std::move(file), data, off, len});
+}
+
+int HttpConn::FillIov_(struct iovec* iov, bool* more) const {
+    const char* buff = writeBuff_.Peek();
+    int cnt = 0;
+    *more = false;
+    for(size_t i = outHead_; i < outQueue_.size() && cnt < MAX_IOV; i++) {
+        const OutSeg& seg = outQueue_[i];
+        if(seg.file && !seg.data) {
+            *more = true;
+            break;
+        }
+        if(seg.data) {
+            iov[cnt].iov_base = const_cast<char*>(seg.data + seg.off);
+        }
+        else {
+            iov[cnt].iov_base = const_cast<char*>(buff);
+            buff += seg.len;
+        }
+        iov[cnt].iov_len = seg.len;
+        cnt++;
+    }
+    return cnt;
+}
+
+void HttpConn::Consume_(size_t len) {
+    assert(len <= toWrite_);
+    toWrite_ -= len;
+    while(len > 0) {
+        assert(outHead_ < outQueue_.size());
+        OutSeg& seg = outQueue_[outHead_];
+        size_t n = len < seg.len ? len : seg.len;
+        if(seg.file) {
+            seg.off += n;
+        }
+        else {
+            writeBuff_.Retrieve(n);
+        }
+        seg.len -= n;
+        len -= n;
+        if(seg.len > 0) break;
+        seg.file.reset();
+        outHead_++;
+    }
+    if(outHead_ == outQueue_.size()) {
+        outQueue_.clear();
+        outHead_ = 0;
+        writeBuff_.RetrieveAll();
+    }
+}
+
+void HttpConn::ClearQueue_() {
+    outQueue_.clear();
+    outHead_ = 0;
+    toWrite_ = 0;
 }
\ No newline at end of file
@@ -12,15 +12,25 @@
 #include <arpa/inet.h>   // sockaddr_in
 #include <stdlib.h>      // atoi()
 #include <errno.h>      
+#include <sys/socket.h>  // sendmsg
+#include <sys/sendfile.h>
+#include <vector>
 
 #include "../log/log.h"
 #include "../pool/sqlconnRAII.h"
 #include "../buffer/buffer.h"
+#include "../buffer/ringbuffer.h"
 #include "httprequest.h"
 #include "httpresponse.h"
 
-class HttpConn {
+/*
+ * HttpConn 作为按 fd 下标的连接槽位预先分配，槽位按缓存行对齐，
+ * 热字段与冷字段分处不同缓存行。
+ */
+class alignas(64) HttpConn {
 public:
+    static const size_t CACHE_LINE = 64;
+
     HttpConn();
 
     ~HttpConn();
@@ -40,7 +50,14 @@ public:
     ssize_t read(int* saveErrno);
 
     /**
-     * 将内部写缓冲区的数据写入套接字
+     * 追加事件后端（io_uring）已代为接收的数据，代替 read
+     */
+    void AppendRead(const char* data, size_t len) {
+        readBuff_.Append(data, len);
+    }
+
+    /**
+     * 按队列顺序发送待写数据，直到 EAGAIN 或本轮发送量达到 WRITE_BUDGET
      * @param saveErrno 用于保存 errno 的指针
      * @return 写入字节数，出错返回 -1
      */
@@ -56,6 +73,14 @@ public:
      */
     int GetFd() const;
 
+    /**
+     * 槽位代数：每次 init 加一。槽位表由所有 Reactor 共享，
+     * 持有旧代数的定时器等回调据此判断槽位是否已被关闭并重新接收
+     */
+    uint32_t GetGen() const {
+        return gen_.load(std::memory_order_acquire);
+    }
+
     /**
      * 获取远端端口号
      */
@@ -72,36 +97,144 @@ public:
     sockaddr_in GetAddr() const;
     
     /**
-     * 处理请求：解析请求、生成响应并准备发送
-     * @return 处理是否成功
+     * 只解析读缓冲区中的下一个请求，不生成响应
+     * @return 是否得到一个完整（或错误）的请求；请求不完整时返回 false 并保留解析进度
+     */
+    bool Parse();
+
+    /**
+     * 已解析的请求是否需要阻塞操作（数据库校验）才能生成响应
+     */
+    bool IsBlocking() const {
+        return parseOk_ && request_.NeedVerify();
+    }
+
+    /**
+     * 为已解析的请求生成响应（必要时先执行阻塞的数据库校验），追加到输出队列末尾
+     */
+    void Respond();
+
+    /**
+     * 阻塞请求所在的线程池已满时调用：为已解析的请求回复 503，发送后关闭连接
      */
-    bool process();
+    void Reject();
 
-    int ToWriteBytes() { 
-        return iov_[0].iov_len + iov_[1].iov_len; 
+    /**
+     * 最后一个响应是否有等待在线压缩的内容，需交给压缩线程池执行 CompressBody
+     */
+    bool NeedCompress() const {
+        return response_.HasDeferredBody();
     }
 
+    /**
+     * 压缩等待中的动态内容，以 chunked 编码追加到输出队列（在压缩线程池中调用）
+     */
+    void CompressBody();
+
+    /**
+     * 是否可以继续解析流水线中的下一个请求：
+     * 已排队的响应都是长连接、没有等待压缩或生成的内容，且输出队列未超过一次 writev 的容量
+     */
+    bool CanPipeline() const {
+        return keepAlive_ && !NeedCompress() && !generator_ && outQueue_.size() - outHead_ + 2 <= MAX_IOV;
+    }
+
+    /**
+     * 连接回到等待请求的状态时调用：读写缓冲区都为空则把存储块交还内存池
+     */
+    void ReleaseBuffers();
+
+    size_t ToWriteBytes() const { 
+        return toWrite_; 
+    }
+
+    /**
+     * 最后一个已排队的响应是否保持连接
+     */
     bool IsKeepAlive() const {
-        return request_.IsKeepAlive();
+        return keepAlive_;
     }
 
+    /**
+     * 动态内容的处理函数：在响应 Init 之后、MakeResponse 之前对每个已解析的请求调用，
+     * 可调用 HttpResponse::SetGenerator 代替静态文件。默认为空，只提供静态文件；
+     * 须在服务器开始处理请求前设置，之后所有线程只读
+     */
+    typedef std::function<void(const HttpRequest&, HttpResponse&)> Handler;
+    static Handler handler;
+
     static bool isET;
     static const char* srcDir;
     static std::atomic<int> userCount;
+
+    static const int MAX_IOV = 64;  /* 单次 writev 的最大 iovec 数 */
+    static const size_t WRITE_BUDGET = 1 << 20;  /* 一次写事件最多发送的字节数 */
+    static const size_t GEN_LOW_WATER = 16384;   /* 待发送数据低于该值时继续调用生成内容的处理函数 */
+    static const size_t GEN_HIGH_WATER = 65536;  /* 每次生成到超过该值为止，限制每个连接缓存的生成内容 */
     
 private:
-   
-    int fd_;
-    struct  sockaddr_in addr_;
+    /*
+     * 输出队列中的一段：写缓冲区中的响应头（file 为空）、
+     * 内容在内存中的小文件或其完整响应（data），或用 sendfile 发送的大文件（file->fd）
+     */
+    struct OutSeg {
+        CachedFilePtr file;  /* 持有缓存文件的引用，文件被淘汰后仍可发送完 */
+        const char* data;    /* 内存段（文件内容或预先序列化的完整响应）起始地址，sendfile 段为空 */
+        size_t off;          /* 下一个待发送字节在内容中的偏移 */
+        size_t len;          /* 剩余字节数 */
+    };
 
+    /**
+     * 追加写缓冲区中新写入的 len 字节，与队尾的缓冲区段相邻时合并
+     */
+    void PushBuff_(size_t len);
+    /**
+     * 追加一个文件段
+     * @param data 内存中的内容（文件内容或完整响应），为空时用 sendfile 发送 file->fd
+     * @param off 段在内容中的起始偏移（Range 请求的区间起点）
+     */
+    void PushFile_(CachedFilePtr file, const char* data, size_t off, size_t len);
+    /**
+     * 调用处理函数生成内容直到超过 GEN_HIGH_WATER 或生成完毕，写入的内容作为一个缓冲区段入队
+     */
+    void Generate_();
+    /**
+     * 按队列顺序填充 iovec，缓冲区段依次指向 writeBuff_ 中的连续区间，遇到 sendfile 段时停止
+     * @param more 输出：后面是否紧跟 sendfile 段（此时应以 MSG_MORE 发送，与文件内容合并成满包）
+     * @return 填充的 iovec 数
+     */
+    int FillIov_(struct iovec* iov, bool* more) const;
+    /**
+     * writev 写出 len 字节后，从队头依次消费对应的段
+     */
+    void Consume_(size_t len);
+    /**
+     * 释放输出队列中的全部文件引用并清空队列
+     */
+    void ClearQueue_();
+
+    /* 热字段：每次事件分发都会访问，集中放在槽位的第一条缓存行 */
+    int fd_;
     bool isClose_;
+    bool keepAlive_;
+
+    size_t toWrite_;                /* 输出队列中待发送的总字节数 */
+    size_t outHead_;                /* 队头下标，之前的段已发送完毕 */
+    std::vector<OutSeg> outQueue_;  /* 按请求顺序排列的待发送段 */
+
+    /* 冷字段：从下一条缓存行开始，避免与热字段共享缓存行 */
+    alignas(CACHE_LINE) struct sockaddr_in addr_;
+    std::atomic<uint32_t> gen_;
     
-    int iovCnt_;
-    struct iovec iov_[2];
-    
-    Buffer readBuff_; // 读缓冲区
+    /* 读缓冲区类型。换成 RingBuffer 后读入与解析都不再搬移数据，
+       但每个活跃连接要多占一个 memfd 的两段映射且空闲时不归还，默认用池化的 Buffer */
+    typedef Buffer ReadBuffer;
+    ReadBuffer readBuff_; // 读缓冲区
     Buffer writeBuff_; // 写缓冲区
 
+    bool parseOk_;
+    bool chunked_;              /* 正在生成的响应体是否使用 chunked 编码 */
+    BodyGenerator generator_;   /* 尚未生成完的响应体，生成完毕后为空 */
     HttpRequest request_;
     HttpResponse response_;
 };
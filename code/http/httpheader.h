@@ -0,0 +1,121 @@
+/*
+ * @Date         : 2026-10-18
+ * @copyleft Apache 2.0
+ */
+#ifndef HTTP_HEADER_H
+#define HTTP_HEADER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string_view>
+
+/*
+ * HttpHeader: 服务器自己要读取的请求头。
+ * 名称到编号的映射是编译期生成的完美哈希：取长度与首、中、尾三个字节（忽略大小写）计算槽位，
+ * 每个槽位至多对应一个名称，查找只需一次哈希和一次比较，解析请求头时据此把值登记到固定槽位。
+ */
+class HttpHeader {
+public:
+    enum Id {
+        CONNECTION = 0,
+        CONTENT_LENGTH,
+        CONTENT_TYPE,
+        HOST,
+        RANGE,
+        ACCEPT_ENCODING,
+        IF_NONE_MATCH,
+        IF_MODIFIED_SINCE,
+        IF_RANGE,
+        TRANSFER_ENCODING,
+        KNOWN_NUM,
+        UNKNOWN = KNOWN_NUM,
+    };
+
+    /**
+     * 按名称（不区分大小写）查找编号
+     * @return 已知请求头的编号，其他名称返回 UNKNOWN
+     */
+    static constexpr Id Lookup(std::string_view name) {
+        if(name.size() < MIN_LEN || name.size() > MAX_LEN) return UNKNOWN;
+        int id = SLOTS_.slot[Hash_(name, SEED_)];
+        if(id < 0 || !EqualNoCase_(name, NAMES[id])) return UNKNOWN;
+        return static_cast<Id>(id);
+    }
+
+    static constexpr std::string_view NAMES[KNOWN_NUM] = {
+        "Connection", "Content-Length", "Content-Type", "Host", "Range",
+        "Accept-Encoding", "If-None-Match", "If-Modified-Since", "If-Range", "Transfer-Encoding",
+    };
+
+private:
+    static const size_t SLOT_NUM = 32;
+    static const size_t MIN_LEN = 4;
+    static const size_t MAX_LEN = 17;
+
+    static constexpr char Lower_(char ch) {
+        return (ch >= 'A' && ch <= 'Z') ? ch + ('a' - 'A') : ch;
+    }
+
+    static constexpr bool EqualNoCase_(std::string_view a, std::string_view b) {
+        if(a.size() != b.size()) return false;
+        for(size_t i = 0; i < a.size(); i++) {
+            if(Lower_(a[i]) != Lower_(b[i])) return false;
+        }
+        return true;
+    }
+
+    static constexpr size_t Hash_(std::string_view name, uint32_t seed) {
+        uint32_t h = static_cast<uint32_t>(name.size());
+        h = h * seed + static_cast<unsigned char>(Lower_(name[0]));
+        h = h * seed + static_cast<unsigned char>(Lower_(name[name.size() / 2]));
+        h = h * seed + static_cast<unsigned char>(Lower_(name[name.size() - 1]));
+        return (h ^ (h >> 7)) & (SLOT_NUM - 1);
+    }
+
+    /* 编译期从小到大试出第一个使全部名称落在不同槽位的种子 */
+    static constexpr uint32_t FindSeed_() {
+        for(uint32_t seed = 1; seed < 65536; seed++) {
+            bool used[SLOT_NUM] = {};
+            bool ok = true;
+            for(std::string_view name : NAMES) {
+                size_t h = Hash_(name, seed);
+                if(used[h]) {
+                    ok = false;
+                    break;
+                }
+                used[h] = true;
+            }
+            if(ok) return seed;
+        }
+        return 0;
+    }
+
+    struct SlotTable {
+        int8_t slot[SLOT_NUM];
+    };
+
+    static constexpr SlotTable BuildSlots_() {
+        SlotTable table = {};
+        for(size_t i = 0; i < SLOT_NUM; i++) table.slot[i] = -1;
+        for(size_t i = 0; i < KNOWN_NUM; i++) table.slot[Hash_(NAMES[i], SEED_)] = static_cast<int8_t>(i);
+        return table;
+    }
+
+    static const uint32_t SEED_;
+    static const SlotTable SLOTS_;
+};
+
+/* 类定义完整后才能在常量表达式中调用其成员函数，种子与槽位表在类外生成 */
+inline constexpr uint32_t HttpHeader::SEED_ = HttpHeader::FindSeed_();
+inline constexpr HttpHeader::SlotTable HttpHeader::SLOTS_ = HttpHeader::BuildSlots_();
+
+static_assert([] {
+    for(int i = 0; i < HttpHeader::KNOWN_NUM; i++) {
+        if(HttpHeader::Lookup(HttpHeader::NAMES[i]) != i) return false;
+    }
+    return true;
+}(), "known header names collide in the slot table");
+static_assert(HttpHeader::Lookup("CONTENT-length") == HttpHeader::CONTENT_LENGTH);
+static_assert(HttpHeader::Lookup("X-Forwarded-For") == HttpHeader::UNKNOWN);
+
+#endif //HTTP_HEADER_H
\ No newline at end of file
@@ -7,39 +7,68 @@ const std::unordered_set<std::string> HttpRequest::DEFAULT_HTML{
 const std::unordered_map<std::string, int> HttpRequest::DEFAULT_HTML_TAG {
             {"/register.html", 0}, {"/login.html", 1},  };
 
-bool HttpRequest::ParseRequestLine_(const std::string& line) {
-    std::regex pattern("^([^ ]*) ([^ ]*) HTTP/([^ ]*)$");
-    std::smatch subMatch;
-    if(std::regex_match(line, subMatch, pattern)) {
-        method_ = subMatch[1];
-        path_ = subMatch[2];
-        version_ = subMatch[3];
-        state_ = HEADERS;
-        return true;
+bool HttpRequest::ParseRequestLine_(const char* line, const char* end) {
+    /* METHOD SP TARGET SP HTTP/VERSION */
+    const char* sp1 = HttpScan::FindChar(line, end, ' ');
+    if(sp1 == end || sp1 == line || HttpScan::FindNonToken(line, sp1) != sp1) {
+        LOG_ERROR("Bad Requestline");
+        return false;
+    }
+    const char* target = sp1 + 1;
+    const char* sp2 = HttpScan::FindChar(target, end, ' ');
+    if(sp2 == end || sp2 == target) {
+        LOG_ERROR("Bad Requestline");
+        return false;
     }
-    LOG_ERROR("Bad Requestline");
-    return false;
+    const char* version = sp2 + 1;
+    if(end - version <= 5 || memcmp(version, "HTTP/", 5) != 0 || HttpScan::FindChar(version, end, ' ') != end) {
+        LOG_ERROR("Bad Requestline");
+        return false;
+    }
+    method_ = Span_(line, sp1);
+    path_.assign(target, sp2);
+    version_ = Span_(version + 5, end);
+    return true;
 }
 
-void HttpRequest::ParseHeader_(const std::string& line) {
-    std::regex pattern("^([^ ]*): ([^ ]*)$");
-    std::smatch subMatch;
-    if(std::regex_match(line, subMatch, pattern)) {
-        header_[subMatch[1]] = subMatch[2];
+bool HttpRequest::ParseHeader_(const char* line, const char* end) {
+    const char* colon = HttpScan::FindChar(line, end, ':');
+    if(colon == end || colon == line || HttpScan::FindNonToken(line, colon) != colon) {
+        return false;
     }
-    else {
-        state_ = BODY;
+    const char* value = colon + 1;
+    while(value < end && (*value == ' ' || *value == '\t')) value++;
+    const char* valueEnd = end;
+    while(valueEnd > value && (valueEnd[-1] == ' ' || valueEnd[-1] == '\t')) valueEnd--;
+    if(fieldNum_ >= MAX_FIELDS) {
+        LOG_ERROR("Too many request header fields");
+        return false;
+    }
+    Field field{Span_(line, colon), Span_(value, valueEnd)};
+    if(fieldNum_ < INLINE_FIELDS) fields_[fieldNum_] = field;
+    else moreFields_.push_back(field);
+    fieldNum_++;
+
+    HttpHeader::Id id = HttpHeader::Lookup(std::string_view(line, colon - line));
+    if(id != HttpHeader::UNKNOWN) {
+        if(knownMask_ & (1u << id)) {
+            /* 长度不一致的重复 Content-Length 无法确定请求体边界（RFC 9112 6.3） */
+            return id != HttpHeader::CONTENT_LENGTH || View_(known_[id]) == View_(field.value);
+        }
+        known_[id] = field.value;
+        knownMask_ |= 1u << id;
     }
+    return true;
 }
 
-void HttpRequest::ParseBody_(const std::string& line) {
+void HttpRequest::ParseBody_(std::string_view body) {
     /* 
     todo
     parse multi kinds of http method
     */
-   switch(method_[0]) {
+   switch(View_(method_)[0]) {
    case 'P':
-        body_ = line;
+        body_.assign(body);
         ParsePost_();
         break;
    default:
@@ -48,6 +77,39 @@ void HttpRequest::ParseBody_(const std::string& line) {
 }
 
 void HttpRequest::ParsePath_() {
+    /*
+     * 去掉查询串，按 RFC 3986 remove_dot_segments 消除 "." 与 ".."，合并重复的 '/'，
+     * 结果不会越出资源根目录，也作为文件缓存的键
+     */
+    size_t query = path_.find('?');
+    if(query != std::string::npos) path_.resize(query);
+    if(path_.empty() || path_[0] != '/' || path_.find("/.") != std::string::npos
+            || path_.find("//") != std::string::npos) {
+        std::string norm;
+        norm.reserve(path_.size() + 1);
+        size_t i = 0;
+        while(i < path_.size()) {
+            if(path_[i] == '/') {
+                i++;
+                continue;
+            }
+            size_t j = path_.find('/', i);
+            if(j == std::string::npos) j = path_.size();
+            std::string_view seg(path_.data() + i, j - i);
+            if(seg == "..") {
+                size_t slash = norm.rfind('/');
+                norm.resize(slash == std::string::npos ? 0 : slash);
+            }
+            else if(seg != ".") {
+                norm += '/';
+                norm += seg;
+            }
+            i = j;
+        }
+        if(norm.empty() || (path_.back() == '/' && norm.back() != '/')) norm += '/';
+        path_.swap(norm);
+    }
+
     if(path_ == "/") {
         path_ = "/index.html";
     }
@@ -59,19 +121,14 @@ void HttpRequest::ParsePath_() {
 }
 
 void HttpRequest::ParsePost_() {
-    if(header_["Content-Type"] == "application/x-www-form-urlencoded") {
+    if(GetHeader(HttpHeader::CONTENT_TYPE) == "application/x-www-form-urlencoded") {
         ParseFromUrlencoded_();
         if(DEFAULT_HTML_TAG.contains(path_)) {
             int tag = DEFAULT_HTML_TAG.find(path_)->second;
             LOG_DEBUG("Tag: %d", tag);
             if(tag == 0 || tag == 1) {
-                bool isLogin = (tag == 1);
-                if(UserVerify(post_["username"], post_["password"], isLogin)) {
-                    path_ = "/welcome.html";
-                }
-                else {
-                    path_ = "/error.html";
-                }
+                /* 数据库校验推迟到 Verify，解析本身不阻塞 */
+                verifyTag_ = tag;
             }
         }
     }
@@ -81,42 +138,61 @@ void HttpRequest::ParseFromUrlencoded_() {
     if(body_.size() == 0) return;
 
     std::string key, value;
-    int num = 0;
-    int n = body_.size();
-    int i = 0, j = 0;
+    std::string* cur = &key;
+    const char* p = body_.data();
+    const char* end = p + body_.size();
 
-    for(; i < n; i++) {
-        char ch = body_[i];
-        switch(ch) {
+    while(p < end) {
+        /* 普通字符整段拷贝，只在分隔符和转义处停下 */
+        const char* q = HttpScan::FindAny(p, end, "=+%&");
+        cur->append(p, q);
+        if(q == end) break;
+        switch(*q) {
         case '=':
-            key = body_.substr(j, i - j);
-            j = i + 1;
+            if(cur == &key) cur = &value;
+            else cur->push_back('=');
             break;
         case '+':
-            body_[i] = ' ';
+            cur->push_back(' ');
             break;
         case '%':
-            num = ConverHex(body_[i + 1]) * 16 + ConverHex(body_[i + 2]);
-            body_[i + 2] = num % 10 + '0';
-            body_[i + 1] = num / 10 + '0';
-            i += 2;
+            if(end - q >= 3) {
+                cur->push_back(static_cast<char>(ConverHex(q[1]) * 16 + ConverHex(q[2])));
+                q += 2;
+            }
+            else {
+                cur->push_back('%');
+            }
             break;
         case '&':
-            value = body_.substr(j, i - j);
-            j = i + 1;
             post_[key] = value;
             LOG_DEBUG("%s = %s", key.c_str(), value.c_str());
+            key.clear();
+            value.clear();
+            cur = &key;
             break;
         default:
             break;
         }
+        p = q + 1;
     }
-    if(!post_.contains(key) && j < i) {
-        value = body_.substr(j, i - j);
+    if(!key.empty()) {
         post_[key] = value;
     }
 }
 
+void HttpRequest::Verify() {
+    if(verifyTag_ < 0) return;
+    bool isLogin = (verifyTag_ == 1);
+    verifyTag_ = -1;
+    if(UserVerify(post_["username"], post_["password"], isLogin)) {
+        path_ = "/welcome.html";
+    }
+    else {
+        path_ = "/error.html";
+    }
+}
+
 bool HttpRequest::UserVerify(const std::string& name, const std::string& pwd, bool isLogin) {
     if(name == "" || pwd == "") return false;
     LOG_INFO("Verify name:%s, pwd:%s", name.c_str(), pwd.c_str());
@@ -183,39 +259,98 @@ bool HttpRequest::UserVerify(const std::string& name, const std::string& pwd, bo
 }
 
 void HttpRequest::Init() {
-    method_ = path_ = version_ = body_ = "";
+    path_ = body_ = "";
+    method_ = version_ = Span{0, 0};
     state_ = REQUEST_LINE;
-    header_.clear();
+    verifyTag_ = -1;
+    base_ = nullptr;
+    checked_ = scanned_ = contentLen_ = 0;
+    fieldNum_ = 0;
+    moreFields_.clear();
+    knownMask_ = 0;
     post_.clear();
 }
 
-bool HttpRequest::parse(Buffer& buff) {
-    const char CRLF[] = "\r\n";
-    if(buff.ReadableBytes() <= 0) return false;
+HttpRequest::HTTP_CODE HttpRequest::Parse_(const char* begin, const char* end, size_t* consumed) {
+    if(state_ == FINISH) {
+        Init();
+    }
+    /* 缓冲区可能在两次读之间搬移，所有位置都以 base_ 为基准记录 */
+    base_ = begin;
 
-    while(buff.ReadableBytes() && state_ != FINISH) {
-        const char* lineEnd = std::search(buff.Peek(), buff.BeginWriteConst(), CRLF, CRLF + 2);
-        std::string line(buff.Peek(), lineEnd);
+    while(state_ != FINISH) {
+        if(state_ == BODY) {
+            if(static_cast<size_t>(end - base_) < checked_ + contentLen_) {
+                return NO_REQUEST;
+            }
+            ParseBody_(std::string_view(base_ + checked_, contentLen_));
+            checked_ += contentLen_;
+            state_ = FINISH;
+            break;
+        }
+
+        const char* lineBegin = base_ + checked_;
+        const char* lineEnd = HttpScan::FindCRLF(base_ + scanned_, end);
+        if(!lineEnd) {
+            /* 末尾可能是半个 CRLF，下次从它开始扫描 */
+            scanned_ = (end - base_) > 0 ? (end - base_) - 1 : 0;
+            if(static_cast<size_t>(end - base_) > MAX_HEAD_SIZE) {
+                LOG_ERROR("Request header too large");
+                *consumed = end - base_;
+                state_ = FINISH;
+                return BAD_REQUEST;
+            }
+            return NO_REQUEST;
+        }
+        checked_ = scanned_ = lineEnd + 2 - base_;
+        if(checked_ > MAX_HEAD_SIZE) {
+            /* 完整的短行不会走到上面的检查，已解析的请求行与请求头同样受总长度限制 */
+            LOG_ERROR("Request header too large");
+            *consumed = end - base_;
+            state_ = FINISH;
+            return BAD_REQUEST;
+        }
+
+        bool ok = true;
         switch(state_) {
         case REQUEST_LINE:
-            if(!ParseRequestLine_(line)) return false;
-            ParsePath_();
+            ok = ParseRequestLine_(lineBegin, lineEnd);
+            if(ok) {
+                ParsePath_();
+                state_ = HEADERS;
+            }
             break;
         case HEADERS:
-            ParseHeader_(line);
-            if(buff.ReadableBytes() <= 2) state_ = FINISH;
-            break;
-        case BODY:
-            ParseBody_(line);
+            if(lineBegin == lineEnd) {
+                std::string_view len = GetHeader(HttpHeader::CONTENT_LENGTH);
+                contentLen_ = 0;
+                for(char ch : len) {
+                    if(ch < '0' || ch > '9' || contentLen_ > MAX_BODY_SIZE) {
+                        ok = false;
+                        break;
+                    }
+                    contentLen_ = contentLen_ * 10 + (ch - '0');
+                }
+                if(contentLen_ > MAX_BODY_SIZE || (knownMask_ & (1u << HttpHeader::TRANSFER_ENCODING))) ok = false;
+                state_ = contentLen_ > 0 ? BODY : FINISH;
+            }
+            else {
+                ok = ParseHeader_(lineBegin, lineEnd);
+            }
             break;
-        default: 
+        default:
             break;
         }
-        if(lineEnd == buff.BeginWrite()) break;
-        buff.RetrieveUntil(lineEnd + 2);
+        if(!ok) {
+            *consumed = end - base_;
+            state_ = FINISH;
+            return BAD_REQUEST;
+        }
     }
-    LOG_DEBUG("[%s] [%s] [%s]", method_.c_str(), path_.c_str(), version_.c_str());
-    return true;
+    *consumed = checked_;
+    LOG_DEBUG("[%.*s] [%s] [%.*s]", (int)method_.len, base_ + method_.off, path_.c_str(),
+              (int)version_.len, base_ + version_.off);
+    return GET_REQUEST;
 }
 
 std::string HttpRequest::path() const {
@@ -226,12 +361,24 @@ std::string& HttpRequest::path() {
     return path_;
 }
 
-std::string HttpRequest::method() const {
-    return method_;
+std::string_view HttpRequest::method() const {
+    return View_(method_);
+}
+
+std::string_view HttpRequest::version() const {
+    return View_(version_);
 }
 
-std::string HttpRequest::version() const {
-    return version_;
+std::string_view HttpRequest::GetHeader(std::string_view key) const {
+    HttpHeader::Id id = HttpHeader::Lookup(key);
+    if(id != HttpHeader::UNKNOWN) return GetHeader(id);
+    for(size_t i = 0; i < fieldNum_; i++) {
+        const Field& field = i < INLINE_FIELDS ? fields_[i] : moreFields_[i - INLINE_FIELDS];
+        if(field.name.len == key.size() && strncasecmp(base_ + field.name.off, key.data(), key.size()) == 0) {
+            return View_(field.value);
+        }
+    }
+    return std::string_view();
 }
 
 std::string HttpRequest::GetPost(const std::string& key) const {
@@ -245,10 +392,12 @@ std::string HttpRequest::GetPost(const char* key) const {
 }
 
 bool HttpRequest::IsKeepAlive() const {
-    if(header_.contains("Connection")) {
-        return header_.find("Connection")->second == "keep-alive";
+    /* HTTP/1.1 默认长连接，HTTP/1.0 需显式声明 */
+    std::string_view conn = GetHeader(HttpHeader::CONNECTION);
+    if(version() == "1.1") {
+        return conn.size() != 5 || strncasecmp(conn.data(), "close", 5) != 0;
     }
-    return false;
+    return conn.size() == 10 && strncasecmp(conn.data(), "keep-alive", 10) == 0;
 }
 
 int HttpRequest::ConverHex(char ch) {
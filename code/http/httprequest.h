@@ -9,11 +9,15 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <string>
-#include <regex>
+#include <string_view>
+#include <vector>
+#include <strings.h>   // strncasecmp
 #include <errno.h>     
 #include <mysql/mysql.h>  //mysql
 
 #include "../buffer/buffer.h"
+#include "httpscan.h"
+#include "httpheader.h"
 #include "../log/log.h"
 #include "../pool/sqlconnpool.h"
 #include "../pool/sqlconnRAII.h"
@@ -56,11 +60,21 @@ public:
      */
     void Init();
     /**
-     * 从缓冲区解析 HTTP 请求
-     * @param buff 包含来自连接的原始数据的缓冲区
-     * @return HTTP_CODE 表示解析结果（是否完整、错误等）
+     * 从缓冲区解析 HTTP 请求。直接在缓冲区字节上运行的状态机，
+     * 数据不完整时保存进度并返回 NO_REQUEST，下次读到新数据后从断点继续；
+     * 请求完整时消费其字节并返回 GET_REQUEST，下一次调用开始解析新的请求。
+     * method/version/header 返回指向缓冲区的 string_view，在下一次向该缓冲区读入数据前有效。
+     * @param buff 包含来自连接的原始数据的缓冲区（Buffer 或 RingBuffer）
+     * @return NO_REQUEST 数据不完整，GET_REQUEST 解析完成，BAD_REQUEST 报文错误
      */
-    bool parse(Buffer& buff);
+    template<class Buff>
+    HTTP_CODE parse(Buff& buff) {
+        size_t consumed = 0;
+        HTTP_CODE ret = Parse_(buff.Peek(), buff.BeginWriteConst(), &consumed);
+        /* 只移动读指针，请求字节在下一次读入前仍然有效 */
+        if(ret != NO_REQUEST) buff.Retrieve(consumed);
+        return ret;
+    }
 
     /**
      * 请求路径（只读）
@@ -73,11 +87,21 @@ public:
     /**
      * HTTP 方法（如 GET/POST）
      */
-    std::string method() const;
+    std::string_view method() const;
     /**
-     * HTTP 版本字符串（如 HTTP/1.1）
+     * HTTP 版本号（如 1.1）
      */
-    std::string version() const;
+    std::string_view version() const;
+    /**
+     * 按名称（不区分大小写）查找请求头，不存在时返回空
+     */
+    std::string_view GetHeader(std::string_view key) const;
+    /**
+     * 按编号取已知请求头，直接读槽位，不存在时返回空
+     */
+    std::string_view GetHeader(HttpHeader::Id id) const {
+        return (knownMask_ & (1u << id)) ? View_(known_[id]) : std::string_view();
+    }
     /**
      * 从解析后的 POST 数据中获取键对应的值（std::string key）
      */
@@ -92,6 +116,15 @@ public:
      */
     bool IsKeepAlive() const;
 
+    /**
+     * 请求是否还有待执行的用户校验（登录/注册，需要阻塞访问数据库）
+     */
+    bool NeedVerify() const { return verifyTag_ >= 0; }
+    /**
+     * 执行用户校验并根据结果改写请求路径（阻塞，应在线程池中调用）
+     */
+    void Verify();
+
     /* 
     todo 
     void HttpConn::ParseFormData() {}
@@ -99,19 +132,42 @@ public:
     */
 
 private:
+    /* 相对请求起始位置的字节区间，缓冲区扩容搬移后依然有效 */
+    struct Span {
+        uint32_t off;
+        uint32_t len;
+    };
+    struct Field {
+        Span name;
+        Span value;
+    };
+
+    /**
+     * 解析 [begin, end) 中的数据，与缓冲区类型无关的状态机本体
+     * @param consumed 返回 GET_REQUEST 时为请求的字节数，BAD_REQUEST 时为全部数据
+     */
+    HTTP_CODE Parse_(const char* begin, const char* end, size_t* consumed);
     /**
      * 解析请求行（例如：GET /index.html HTTP/1.1）
      * @return 是否解析成功
      */
-    bool ParseRequestLine_(const std::string& line);
+    bool ParseRequestLine_(const char* line, const char* end);
     /**
      * 解析单个请求头行（Header: value）
+     * @return 是否解析成功
      */
-    void ParseHeader_(const std::string& line);
+    bool ParseHeader_(const char* line, const char* end);
     /**
      * 解析请求体（如 POST 的表单或 JSON）
      */
-    void ParseBody_(const std::string& line);
+    void ParseBody_(std::string_view body);
+
+    std::string_view View_(Span span) const {
+        return std::string_view(base_ + span.off, span.len);
+    }
+    Span Span_(const char* begin, const char* end) const {
+        return Span{static_cast<uint32_t>(begin - base_), static_cast<uint32_t>(end - begin)};
+    }
 
     /**
      * 处理并规范化请求路径（去除 .. 等危险路径）
@@ -128,9 +184,28 @@ private:
 
     static bool UserVerify(const std::string& name, const std::string& pwd, bool isLogin);
 
+    static const size_t MAX_HEAD_SIZE = 65536;
+    static const size_t MAX_BODY_SIZE = 1048576;
+    static const size_t INLINE_FIELDS = 32;
+    static const size_t MAX_FIELDS = 100;   /* 请求头行数上限，超过时按报文错误处理 */
+
     PARSE_STATE state_;
-    std::string method_, path_, version_, body_;
-    std::unordered_map<std::string, std::string> header_;
+    int verifyTag_;  /* 待执行的校验：-1 无，0 注册，1 登录 */
+
+    const char* base_;    /* 当前请求在缓冲区中的起始位置 */
+    size_t checked_;      /* 已解析完成的字节数 */
+    size_t scanned_;      /* 已查找过 CRLF 的字节数，断点续扫时跳过 */
+    size_t contentLen_;
+
+    Span method_, version_;
+    std::string path_, body_;
+    /* 请求头按出现顺序存放，常见请求不超过内联容量，不需要分配内存 */
+    Field fields_[INLINE_FIELDS];
+    std::vector<Field> moreFields_;
+    size_t fieldNum_;
+    /* 已知请求头的值按编号登记，同名出现多次时取第一个 */
+    Span known_[HttpHeader::KNOWN_NUM];
+    uint32_t knownMask_;
     std::unordered_map<std::string, std::string> post_;
 
     static const std::unordered_set<std::string> DEFAULT_HTML;
@@ -1,156 +1,532 @@
 #include "httpresponse.h"
 
-const std::unordered_map<std::string, std::string> HttpResponse::SUFFIX_TYPE = {
-    { ".html",  "text/html" },
-    { ".xml",   "text/xml" },
-    { ".xhtml", "application/xhtml+xml" },
-    { ".txt",   "text/plain" },
-    { ".rtf",   "application/rtf" },
-    { ".pdf",   "application/pdf" },
-    { ".word",  "application/nsword" },
-    { ".png",   "image/png" },
-    { ".gif",   "image/gif" },
-    { ".jpg",   "image/jpeg" },
-    { ".jpeg",  "image/jpeg" },
-    { ".au",    "audio/basic" },
-    { ".mpeg",  "video/mpeg" },
-    { ".mpg",   "video/mpeg" },
-    { ".avi",   "video/x-msvideo" },
-    { ".gz",    "application/x-gzip" },
-    { ".tar",   "application/x-tar" },
-    { ".css",   "text/css "},
-    { ".js",    "text/javascript "},
+size_t HttpResponse::compressMin = 0;
+
+/* 编译期拼好的头部行，按字节直接追加到缓冲区 */
+struct HeaderLine {
+    char data[64];
+    size_t len;
+    std::string_view View() const { return std::string_view(data, len); }
 };
 
-const std::unordered_map<int, std::string> HttpResponse::CODE_STATUS = {
-    { 200, "OK" },
-    { 400, "Bad Request" },
-    { 403, "Forbidden" },
-    { 404, "Not Found" },
+static constexpr HeaderLine MakeLine(std::initializer_list<std::string_view> parts) {
+    HeaderLine line{};
+    for(std::string_view part : parts) {
+        for(char ch : part) line.data[line.len++] = ch;
+    }
+    return line;
+}
+
+static constexpr std::string_view CONTENT_TYPE = "Content-type: ";
+
+struct MimeEntry {
+    std::string_view suffix;
+    HeaderLine line;   /* "Content-type: <type>\r\n" */
 };
 
-const std::unordered_map<int, std::string> HttpResponse::CODE_PATH = {
-    { 400, "/400.html" },
-    { 403, "/403.html" },
-    { 404, "/404.html" },
+static constexpr MimeEntry Mime(std::string_view suffix, std::string_view type) {
+    return MimeEntry{suffix, MakeLine({CONTENT_TYPE, type, "\r\n"})};
+}
+
+static constexpr MimeEntry MIME_TYPES[] = {
+    Mime(".html",  "text/html"),
+    Mime(".xml",   "text/xml"),
+    Mime(".xhtml", "application/xhtml+xml"),
+    Mime(".txt",   "text/plain"),
+    Mime(".rtf",   "application/rtf"),
+    Mime(".pdf",   "application/pdf"),
+    Mime(".word",  "application/nsword"),
+    Mime(".png",   "image/png"),
+    Mime(".gif",   "image/gif"),
+    Mime(".jpg",   "image/jpeg"),
+    Mime(".jpeg",  "image/jpeg"),
+    Mime(".au",    "audio/basic"),
+    Mime(".mpeg",  "video/mpeg"),
+    Mime(".mpg",   "video/mpeg"),
+    Mime(".avi",   "video/x-msvideo"),
+    Mime(".gz",    "application/x-gzip"),
+    Mime(".tar",   "application/x-tar"),
+    Mime(".css",   "text/css"),
+    Mime(".js",    "text/javascript"),
+    Mime(".json",  "application/json"),
+    Mime(".svg",   "image/svg+xml"),
+    Mime(".ico",   "image/x-icon"),
+    Mime(".ttf",   "font/ttf"),
+    Mime(".otf",   "font/otf"),
+    Mime(".eot",   "application/vnd.ms-fontobject"),
+    Mime(".woff",  "font/woff"),
+    Mime(".woff2", "font/woff2"),
 };
 
-void HttpResponse::AddStateLine_(Buffer &buff) {
-    std::string status;
-    if(!CODE_STATUS.contains(code_)) {
-        code_ = 400;
+static constexpr MimeEntry DEFAULT_MIME = Mime("", "text/plain");
+
+struct Status {
+    int code;
+    HeaderLine line;          /* "HTTP/1.1 <code> <reason>\r\n" */
+    std::string_view reason;
+    const char* page;         /* 错误页面，没有时为空 */
+};
+
+static constexpr Status MakeStatus(int code, std::string_view reason, const char* page = nullptr) {
+    const char digits[3] = {static_cast<char>('0' + code / 100), static_cast<char>('0' + code / 10 % 10),
+                            static_cast<char>('0' + code % 10)};
+    return Status{code, MakeLine({"HTTP/1.1 ", std::string_view(digits, 3), " ", reason, "\r\n"}), reason, page};
+}
+
+static constexpr Status STATUS[] = {
+    MakeStatus(200, "OK"),
+    MakeStatus(206, "Partial Content"),
+    MakeStatus(304, "Not Modified"),
+    MakeStatus(400, "Bad Request", "/400.html"),
+    MakeStatus(403, "Forbidden", "/403.html"),
+    MakeStatus(404, "Not Found", "/404.html"),
+    MakeStatus(416, "Range Not Satisfiable"),
+    MakeStatus(503, "Service Unavailable"),
+};
+
+/* 状态码到 STATUS 下标的直接映射，-1 表示不支持 */
+struct StatusIndex {
+    static const int BASE = 100;
+    static const int SIZE = 500;
+    int8_t index[SIZE];
+};
+
+static constexpr StatusIndex MakeStatusIndex() {
+    StatusIndex table{};
+    for(int8_t& idx : table.index) idx = -1;
+    for(size_t i = 0; i < sizeof(STATUS) / sizeof(STATUS[0]); i++) {
+        table.index[STATUS[i].code - StatusIndex::BASE] = static_cast<int8_t>(i);
+    }
+    return table;
+}
+
+static constexpr StatusIndex STATUS_INDEX = MakeStatusIndex();
+
+/* 不支持的状态码按 400 处理 */
+static const Status& FindStatus(int* code) {
+    int idx = -1;
+    if(*code >= StatusIndex::BASE && *code < StatusIndex::BASE + StatusIndex::SIZE) {
+        idx = STATUS_INDEX.index[*code - StatusIndex::BASE];
+    }
+    if(idx < 0) {
+        *code = 400;
+        idx = STATUS_INDEX.index[400 - StatusIndex::BASE];
+    }
+    return STATUS[idx];
+}
+
+/* 两位一组的十进制查表 */
+static constexpr char DIGIT_PAIRS[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/**
+ * 从 end 向前写入 val 的十进制表示
+ * @return 首个数字的位置
+ */
+static char* FormatDecimal(char* end, uint64_t val) {
+    while(val >= 100) {
+        const char* pair = DIGIT_PAIRS + (val % 100) * 2;
+        val /= 100;
+        *--end = pair[1];
+        *--end = pair[0];
+    }
+    if(val >= 10) {
+        *--end = DIGIT_PAIRS[val * 2 + 1];
+        *--end = DIGIT_PAIRS[val * 2];
+    }
+    else {
+        *--end = static_cast<char>('0' + val);
     }
-    status = CODE_STATUS.find(code_)->second;
-    buff.Append("HTTP/1.1" + std::to_string(code_) + " " + status + "\r\n");
+    return end;
+}
+
+static void AppendDecimal(Buffer& buff, uint64_t val) {
+    char digits[20];
+    char* begin = FormatDecimal(digits + sizeof(digits), val);
+    buff.Append(begin, digits + sizeof(digits) - begin);
+}
+
+/* 当前线程缓存的 "Date: ...\r\n" 头部行，每秒重新生成一次 */
+static std::string_view DateLine() {
+    static thread_local time_t cachedSec = -1;
+    static thread_local char line[48];
+    static thread_local size_t len = 0;
+    time_t sec = CoarseClock::Now();
+    if(sec != cachedSec) {
+        std::string_view date = CoarseClock::HttpDate();
+        len = snprintf(line, sizeof(line), "Date: %.*s\r\n", static_cast<int>(date.size()), date.data());
+        cachedSec = sec;
+    }
+    return std::string_view(line, len);
+}
+
+void HttpResponse::AddStateLine_(Buffer &buff) {
+    buff.Append(FindStatus(&code_).line.View());
+    buff.Append(DateLine());
 }
 
 void HttpResponse::AddHeader_(Buffer &buff) {
-    buff.Append("Connection: ");
     if(isKeepAlive_) {
-        buff.Append("keep-alive\r\n");
-        buff.Append("keep-alive: max=6, timeout=120\r\n");
+        buff.Append("Connection: keep-alive\r\nkeep-alive: max=6, timeout=120\r\n");
     }
     else {
-        buff.Append("close\r\n");
+        buff.Append("Connection: close\r\n");
     }
-    buff.Append("Content-type: " + GetFileType_() + "\r\n");
 }
 
 void HttpResponse::AddContent_(Buffer &buff) {
-    int srcFd = open((srcDir_ + path_).data(), O_RDONLY);
-    if(srcFd < 0) {
-        ErrorContent(buff, "File Not Found");
+    if(code_ == 304) {
+        /* 304 只带验证器，没有响应体 */
+        buff.Append(file_->rep[encoding_].validators);
+        if(file_->encodings != 1u << Compress::IDENTITY) {
+            buff.Append("Vary: Accept-Encoding\r\n");
+        }
+        buff.Append("\r\n");
+        file_.reset();
+        return;
+    }
+    if(code_ == 416) {
+        /* 请求的区间都不在文件内：告知实际长度，不发送文件内容 */
+        buff.Append("Content-range: bytes */");
+        AppendDecimal(buff, file_->size);
+        buff.Append("\r\n");
+        file_.reset();
+    }
+    if(!file_) {
+        buff.Append("Content-type: text/html\r\n");
+        ErrorContent(buff, code_ == 416 ? "Range Not Satisfiable" : code_ == 503 ? "Server busy" : "File Not Found");
         return;
     }
+    if(code_ == 206) {
+        AddRangeHeader_(buff);
+        return;
+    }
+    const CachedFile::Rep& rep = file_->rep[encoding_];
+    if(code_ == 200) {
+        buff.Append("Accept-ranges: bytes\r\n");
+        buff.Append(rep.validators);
+    }
+    /* Content-type、Content-encoding 与 Content-length 在文件载入缓存时已生成 */
+    buff.Append(rep.header);
+}
+
+/* 解析区间中的十进制偏移，不接受空串、符号与溢出 */
+static bool ParseOffset(std::string_view str, size_t* val) {
+    if(str.empty() || str.size() > 18) return false;
+    size_t ret = 0;
+    for(char ch : str) {
+        if(ch < '0' || ch > '9') return false;
+        ret = ret * 10 + (ch - '0');
+    }
+    *val = ret;
+    return true;
+}
+
+/* 解析 IMF-fixdate 格式的 HTTP 日期（如 "Sun, 06 Nov 1994 08:49:37 GMT"） */
+static bool ParseHttpDate(std::string_view str, time_t* t) {
+    char date[64];
+    if(str.empty() || str.size() >= sizeof(date)) return false;
+    memcpy(date, str.data(), str.size());
+    date[str.size()] = '\0';
+    struct tm tm = {};
+    const char* end = strptime(date, "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    if(!end || *end != '\0') return false;
+    *t = timegm(&tm);
+    return true;
+}
+
+/* 比较 ETag 的引号部分；weak 为 true 时忽略 W/ 前缀（弱比较），否则任一方是弱标签都不匹配 */
+static bool EtagMatch(std::string_view a, std::string_view b, bool weak) {
+    bool aWeak = a.starts_with("W/"), bWeak = b.starts_with("W/");
+    if(!weak && (aWeak || bWeak)) return false;
+    if(aWeak) a.remove_prefix(2);
+    if(bWeak) b.remove_prefix(2);
+    return a == b;
+}
+
+bool HttpResponse::NotModified_() const {
+    assert(file_);
+    std::string_view list = headers_.ifNoneMatch;
+    if(!list.empty()) {
+        /* If-None-Match 优先，存在时忽略 If-Modified-Since */
+        while(!list.empty()) {
+            size_t comma = list.find(',');
+            std::string_view tag = list.substr(0, comma);
+            list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+            while(!tag.empty() && (tag.front() == ' ' || tag.front() == '\t')) tag.remove_prefix(1);
+            while(!tag.empty() && (tag.back() == ' ' || tag.back() == '\t')) tag.remove_suffix(1);
+            if(tag == "*" || EtagMatch(tag, file_->rep[encoding_].etag, true)) return true;
+        }
+        return false;
+    }
+    time_t since;
+    return ParseHttpDate(headers_.ifModifiedSince, &since) && file_->mtime <= since;
+}
+
+bool HttpResponse::IfRangeMatch_() const {
+    assert(file_);
+    std::string_view cond = headers_.ifRange;
+    if(cond.empty()) return true;
+    if(cond.front() == '"' || cond.starts_with("W/")) {
+        /* If-Range 要求强比较，弱标签永远不匹配 */
+        return EtagMatch(cond, file_->rep[encoding_].etag, false);
+    }
+    time_t date;
+    return ParseHttpDate(cond, &date) && date == file_->mtime;
+}
+
+void HttpResponse::ParseRange_() {
+    assert(file_);
+    std::string_view spec = headers_.range;
+    if(spec.size() < 6 || strncasecmp(spec.data(), "bytes=", 6) != 0) return;
+    spec.remove_prefix(6);
+
+    const size_t size = file_->size;
+    size_t count = 0;
+    ranges_.clear();
+    while(!spec.empty()) {
+        size_t comma = spec.find(',');
+        std::string_view item = spec.substr(0, comma);
+        spec = comma == std::string_view::npos ? std::string_view() : spec.substr(comma + 1);
+        while(!item.empty() && (item.front() == ' ' || item.front() == '\t')) item.remove_prefix(1);
+        while(!item.empty() && (item.back() == ' ' || item.back() == '\t')) item.remove_suffix(1);
+        if(item.empty()) continue;
+        if(++count > MAX_RANGES) {
+            ranges_.clear();
+            return;
+        }
+
+        size_t dash = item.find('-');
+        if(dash == std::string_view::npos) {
+            ranges_.clear();
+            return;
+        }
+        size_t first = 0, last = 0;
+        if(dash == 0) {
+            /* "-n"：最后 n 个字节 */
+            if(!ParseOffset(item.substr(1), &last)) {
+                ranges_.clear();
+                return;
+            }
+            if(last == 0 || size == 0) continue;
+            first = last < size ? size - last : 0;
+            last = size - 1;
+        }
+        else {
+            if(!ParseOffset(item.substr(0, dash), &first)) {
+                ranges_.clear();
+                return;
+            }
+            if(dash + 1 == item.size()) {
+                last = size - 1;
+            }
+            else if(!ParseOffset(item.substr(dash + 1), &last) || last < first) {
+                ranges_.clear();
+                return;
+            }
+            if(first >= size) continue;
+            if(last >= size) last = size - 1;
+        }
+        ranges_.push_back(ByteRange{first, last - first + 1, std::string()});
+    }
+    /* "bytes=" / "bytes=,," 不含任何区间，与无法解析的 Range 一样忽略；只有全部区间都越界时才是 416 */
+    if(count == 0) return;
+    code_ = ranges_.empty() ? 416 : 206;
+}
 
-    LOG_DEBUG("file path: %s", (srcDir_ + path_).data());
-    int* mmRet = (int*)mmap(0, mmFileStat_.st_size, PROT_READ, MAP_PRIVATE, srcFd, 0);
-    if(*mmRet == 1) {
-        ErrorContent(buff, "File Not Found");
+void HttpResponse::AddRangeHeader_(Buffer& buff) {
+    /* 区间按原始内容计算，带 Range 的请求不选择压缩编码 */
+    assert(file_ && !ranges_.empty() && encoding_ == Compress::IDENTITY);
+    if(ranges_.size() == 1) {
+        const ByteRange& r = ranges_[0];
+        buff.Append(file_->rep[Compress::IDENTITY].validators);
+        buff.Append(file_->mimeLine);
+        AppendRange_(buff, r);
+        buff.Append("Content-length: ");
+        AppendDecimal(buff, r.len);
+        buff.Append("\r\n\r\n");
         return;
     }
-    mmFile_ = (char*)mmRet;
-    close(srcFd);
-    buff.Append("Content-length: " + std::to_string(mmFileStat_.st_size) + "\r\n\r\n");
+    /* 多个区间用 multipart/byteranges 发送，分段头部由 HttpConn 插在各区间内容之前，文件内容仍不拷贝 */
+    static std::atomic<uint64_t> boundarySeq{0};
+    char boundary[24];
+    snprintf(boundary, sizeof(boundary), "%020llu",
+             static_cast<unsigned long long>(boundarySeq.fetch_add(1, std::memory_order_relaxed) + 1));
+    size_t total = 0;
+    Buffer part(128);
+    for(ByteRange& r : ranges_) {
+        part.Append("\r\n--");
+        part.Append(boundary);
+        part.Append("\r\n");
+        part.Append(file_->mimeLine);
+        AppendRange_(part, r);
+        part.Append("\r\n");
+        r.head = part.RetrieveAllToStr();
+        total += r.head.size() + r.len;
+    }
+    rangeTail_.assign("\r\n--").append(boundary).append("--\r\n");
+    total += rangeTail_.size();
+    buff.Append(file_->rep[Compress::IDENTITY].validators);
+    buff.Append("Content-type: multipart/byteranges; boundary=");
+    buff.Append(boundary);
+    buff.Append("\r\nContent-length: ");
+    AppendDecimal(buff, total);
+    buff.Append("\r\n\r\n");
+}
+
+void HttpResponse::AppendRange_(Buffer& buff, const ByteRange& r) const {
+    buff.Append("Content-range: bytes ");
+    AppendDecimal(buff, r.off);
+    buff.Append("-");
+    AppendDecimal(buff, r.off + r.len - 1);
+    buff.Append("/");
+    AppendDecimal(buff, file_->size);
+    buff.Append("\r\n");
 }
 
 void HttpResponse::ErrorHtml_() {
-    if(CODE_PATH.contains(code_)) {
-        path_ = CODE_PATH.find(code_)->second;
-        stat((srcDir_ + path_).data(), &mmFileStat_);
+    const Status& status = FindStatus(&code_);
+    if(status.page) {
+        path_ = status.page;
+        int code = 0;
+        file_ = FileCache::Instance()->Get(path_, &code);
     }
 }
 
-std::string HttpResponse::GetFileType_() {
-    std::string::size_type idx = path_.find_last_of(".");
-    if(idx == std::string::npos) {
-        return "text/plain";
+HttpResponse::MimeType HttpResponse::GetFileType(std::string_view path) {
+    const MimeEntry* mime = &DEFAULT_MIME;
+    size_t idx = path.find_last_of('.');
+    if(idx != std::string_view::npos) {
+        std::string_view suffix = path.substr(idx);
+        for(const MimeEntry& entry : MIME_TYPES) {
+            if(entry.suffix == suffix) {
+                mime = &entry;
+                break;
+            }
+        }
     }
-    std::string suffix = path_.substr(idx);
-    if(SUFFIX_TYPE.contains(suffix)) {
-        return SUFFIX_TYPE.find(suffix)->second;
-    }
-    return "text/plain";
+    std::string_view line = mime->line.View();
+    return MimeType{line.substr(CONTENT_TYPE.size(), line.size() - CONTENT_TYPE.size() - 2), line};
 }
 
 HttpResponse::HttpResponse() {
     code_ = -1;
+    encoding_ = Compress::IDENTITY;
     isKeepAlive_ = false;
-    path_ = srcDir_ = "";
-    mmFile_ = nullptr;
-    mmFileStat_ = {0};
+    preserialized_ = false;
+    path_ = "";
 }
 
 HttpResponse::~HttpResponse() {
-    UnmapFile();
+    CloseFile();
 }
 
-void HttpResponse::Init(const std::string& srcDir, std::string& path, bool isKeepAlive, int code) {
-    assert(srcDir != "");
-    if(mmFile_) UnmapFile();
+void HttpResponse::Init(const std::string& path, bool isKeepAlive, int code, const RequestHeaders& headers) {
+    CloseFile();
     code_ = code;
-    srcDir_ = srcDir;
+    encoding_ = Compress::IDENTITY;
+    preserialized_ = false;
     path_ = path;
+    headers_ = headers;
+    ranges_.clear();
+    rangeTail_.clear();
+    body_.clear();
+    generator_ = nullptr;
     isKeepAlive_ = isKeepAlive;
-    mmFile_ = nullptr;
-    mmFileStat_ = {0};
 }
 
 void HttpResponse::MakeResponse(Buffer &buff) {
-    if(stat((srcDir_ + path_).data(), &mmFileStat_) < 0 || S_ISDIR(mmFileStat_.st_mode)) code_ = 404;
-    else if(!(mmFileStat_.st_mode & S_IROTH)) code_ = 403;
-    else if(code_ == -1) code_ = 200;
+    if(generator_) {
+        /* 处理函数生成的内容：长度未知，不写 Content-length，内容由连接边生成边发送 */
+        if(code_ == -1) code_ = 200;
+        if(!CanChunk_()) isKeepAlive_ = false;
+        AddStateLine_(buff);
+        AddHeader_(buff);
+        buff.Append(CONTENT_TYPE);
+        buff.Append(genMime_);
+        buff.Append("\r\n");
+        buff.Append(CanChunk_() ? "Transfer-encoding: chunked\r\n\r\n" : "\r\n");
+        return;
+    }
+    if(code_ == 400 || code_ == 503) {
+        /* 请求报文错误或服务过载，不再按路径查找文件 */
+    }
+    else {
+        /* 热点文件直接命中缓存，不做 stat/open */
+        int code = 0;
+        file_ = FileCache::Instance()->Get(path_, &code);
+        if(!file_) code_ = code;
+        else if(code_ == -1) code_ = 200;
+        if(file_ && code_ == 200) {
+            if(headers_.range.empty()) {
+                /* 选出客户端接受的预压缩变体，后续的验证器与头部都使用该编码的版本 */
+                encoding_ = Compress::Select(headers_.acceptEncoding, file_->encodings);
+            }
+            if(NotModified_()) {
+                /* 客户端缓存仍然有效，只回复验证器 */
+                code_ = 304;
+            }
+            else if(!headers_.range.empty() && IfRangeMatch_()) {
+                /* 带 Range 的请求只发送所需区间，不使用完整响应 */
+                ParseRange_();
+            }
+        }
+        if(file_ && code_ == 200 && file_->HasResponse(encoding_)) {
+            /* 小文件的响应已预先生成，只需写出状态行与随时间变化的 Date */
+            AddStateLine_(buff);
+            preserialized_ = true;
+            return;
+        }
+    }
     ErrorHtml_();
     AddStateLine_(buff);
     AddHeader_(buff);
     AddContent_(buff);
 }
 
-void HttpResponse::UnmapFile() {
-    if(mmFile_) {
-        munmap(mmFile_, mmFileStat_.st_size);
-        mmFile_ = nullptr;
-    }
+std::string HttpResponse::Preserialize(const CachedFilePtr& file, int encoding, bool isKeepAlive) {
+    assert(file && file->Body(encoding));
+    HttpResponse response;
+    response.code_ = 200;
+    response.encoding_ = encoding;
+    response.isKeepAlive_ = isKeepAlive;
+    response.file_ = file;
+    Buffer buff(static_cast<int>(file->rep[encoding].header.size() + file->Size(encoding) + 256));
+    response.AddHeader_(buff);
+    response.AddContent_(buff);
+    buff.Append(file->Body(encoding), file->Size(encoding));
+    return buff.RetrieveAllToStr();
 }
 
-char* HttpResponse::File() {
-    return mmFile_;
+void HttpResponse::CloseFile() {
+    file_.reset();
 }
 
-size_t HttpResponse::FileLen() const {
-    return mmFileStat_.st_size;
-}
-
-void HttpResponse::ErrorContent(Buffer &buff, std::string message) {
-    std::string body;
-    body += "<html><title>Error</title>";
-    body += "<body bgcolor=\"ffffff\">";
-    if(!CODE_STATUS.contains(code_)) code_ = 400;
-    std::string status = CODE_STATUS.find(code_)->second;
-    body += std::to_string(code_) + " : " + status + "\n";
-    body += "<p>" + message + "</p>";
-    body += "<hr><em>WebServer</em></body></html>";
+void HttpResponse::ErrorContent(Buffer &buff, std::string_view message) {
+    const Status& status = FindStatus(&code_);
+    char digits[4];
+    char* code = FormatDecimal(digits + sizeof(digits), code_);
+    const std::string_view parts[] = {
+        "<html><title>Error</title><body bgcolor=\"ffffff\">",
+        std::string_view(code, digits + sizeof(digits) - code), " : ", status.reason, "\n<p>", message,
+        "</p><hr><em>WebServer</em></body></html>",
+    };
+    size_t len = 0;
+    for(std::string_view part : parts) len += part.size();
 
-    buff.Append("Content-length: " + std::to_string(body.size()) + "\r\n\r\n");
-    buff.Append(body);
+    if(compressMin > 0 && len >= compressMin && CanChunk_()
+            && Compress::Select(headers_.acceptEncoding, 1u << Compress::GZIP) == Compress::GZIP) {
+        /* 动态内容无法预压缩：先写出头部，内容由压缩线程池压缩后以 chunked 编码追加 */
+        buff.Append("Content-encoding: gzip\r\nVary: Accept-Encoding\r\nTransfer-encoding: chunked\r\n\r\n");
+        body_.reserve(len);
+        for(std::string_view part : parts) body_.append(part);
+        return;
+    }
+    /* 内容由各段直接写入缓冲区，不拼接临时字符串 */
+    buff.Append("Content-length: ");
+    AppendDecimal(buff, len);
+    buff.Append("\r\n\r\n");
+    for(std::string_view part : parts) buff.Append(part);
 }
\ No newline at end of file
@@ -6,70 +6,198 @@
 #ifndef HTTP_RESPONSE_H
 #define HTTP_RESPONSE_H
 
-#include <unordered_map>
-#include <fcntl.h>       // open
-#include <unistd.h>      // close
-#include <sys/stat.h>    // stat
-#include <sys/mman.h>    // mmap, munmap
+#include <string>
+#include <string_view>
+#include <vector>
+#include <strings.h>   // strncasecmp
+#include <time.h>      // strptime, timegm
 
 #include "../buffer/buffer.h"
 #include "../log/log.h"
+#include "filecache.h"
+#include "chunkedwriter.h"
 
 class HttpResponse {
 public:
+    /* 206 响应中的一个区间：文件内偏移、长度，以及多区间时位于其内容之前的分段头部 */
+    struct ByteRange {
+        size_t off;
+        size_t len;
+        std::string head;
+    };
+
+    /*
+     * 影响响应内容的请求头，未携带时为空。
+     * 指向请求所在的读缓冲区，只需在 Init 到 MakeResponse 返回之间有效
+     */
+    struct RequestHeaders {
+        std::string_view range;
+        std::string_view ifRange;
+        std::string_view ifNoneMatch;
+        std::string_view ifModifiedSince;
+        std::string_view acceptEncoding;
+        std::string_view version;   /* 请求的 HTTP 版本，HTTP/1.0 客户端不能接收 chunked 编码 */
+    };
+
     HttpResponse();
     ~HttpResponse();
 
     /**
      * 初始化响应对象
-     * @param srcDir 资源根目录
-     * @param path 请求资源路径（相对 srcDir）
+     * @param path 请求资源路径（相对资源根目录）
      * @param isKeepAlive 是否保持长连接
      * @param code HTTP 状态码（-1 表示正常处理）
+     * @param headers 条件请求与 Range 相关的请求头
      */
-    void Init(const std::string& srcDir, std::string& path, bool isKeepAlive = false, int code = -1);
+    void Init(const std::string& path, bool isKeepAlive = false, int code = -1, const RequestHeaders& headers = {});
     /**
      * 根据当前响应状态构建 HTTP 响应并写入缓冲区
      */
     void MakeResponse(Buffer& buff);
     /**
-     * 解除 mmap 映射（如果有映射文件）
+     * 释放对文件的引用
+     */
+    void CloseFile();
+    /**
+     * 响应体对应的缓存文件，没有文件（错误页面由缓冲区生成）时为空
+     */
+    const CachedFilePtr& File() const { return file_; }
+    /**
+     * 交出文件引用，由输出队列持有到发送完成
+     */
+    CachedFilePtr ReleaseFile() { return std::move(file_); }
+    /**
+     * 响应体来自文件的长度（选中编码的内容长度）
+     */
+    size_t FileLen() const { return file_ ? file_->Size(encoding_) : 0; }
+    /**
+     * 按 Accept-Encoding 选中的内容编码（Compress::Encoding）
+     */
+    int Encoding() const { return encoding_; }
+    /**
+     * 206 响应要发送的文件区间，按请求顺序排列；其他响应为空，发送整个文件
      */
-    void UnmapFile();
+    const std::vector<ByteRange>& Ranges() const { return ranges_; }
     /**
-     * 返回映射的文件地址
+     * 多区间响应的结束分隔行，紧跟在最后一个区间之后发送；单区间时为空
      */
-    char* File();
+    const std::string& RangeTail() const { return rangeTail_; }
     /**
-     * 返回映射文件长度
+     * 构造错误内容并写入缓冲区。内容不小于 compressMin 且客户端接受 gzip 时只写入
+     * chunked 与 gzip 的头部，内容留待压缩线程池处理（见 HasDeferredBody）
      */
-    size_t FileLen() const;
+    void ErrorContent(Buffer& buff, std::string_view message);
     /**
-     * 构造错误内容并写入缓冲区
+     * 以处理函数分段生成的内容代替文件作为响应体，在 Init 之后、MakeResponse 之前调用。
+     * HTTP/1.1 用 chunked 编码边生成边发送；HTTP/1.0 不支持 chunked，改为以关闭连接结束响应体
+     * @param mime 内容的 Content-type
      */
-    void ErrorContent(Buffer& buff, std::string message);
+    void SetGenerator(const std::string& mime, BodyGenerator generator) {
+        genMime_ = mime;
+        generator_ = std::move(generator);
+    }
+    bool HasGenerator() const { return static_cast<bool>(generator_); }
+    /**
+     * 取出处理函数，由连接在输出队列低于水位时调用
+     */
+    BodyGenerator TakeGenerator() { return std::move(generator_); }
+    /**
+     * 生成的内容是否使用 chunked 编码
+     */
+    bool IsChunked() const { return CanChunk_(); }
+    /**
+     * 响应是否保持连接（HTTP/1.0 的生成内容会关闭连接）
+     */
+    bool IsKeepAlive() const { return isKeepAlive_; }
+    /**
+     * 是否有等待在线压缩的动态内容
+     */
+    bool HasDeferredBody() const { return !body_.empty(); }
+    /**
+     * 取出等待压缩的动态内容
+     */
+    std::string TakeBody() { return std::move(body_); }
     int Code() const { return code_; }
 
+    /**
+     * 是否命中预先序列化的响应：此时 MakeResponse 只向缓冲区写入状态行与 Date，其后应发送 FullResponse()
+     */
+    bool IsPreserialized() const { return preserialized_; }
+    /**
+     * 预先序列化的响应（状态行与 Date 之后的头部和内容），须在 ReleaseFile 之前取得
+     */
+    const std::string& FullResponse() const {
+        assert(preserialized_ && file_);
+        return file_->rep[encoding_].response[isKeepAlive_ ? 1 : 0];
+    }
+
+    /* 后缀对应的 MIME 类型与完整的 "Content-type: ...\r\n" 头部行，都指向编译期生成的静态表 */
+    struct MimeType {
+        std::string_view type;
+        std::string_view line;
+    };
+
+    /**
+     * 按后缀返回 MIME 类型，未知后缀为 text/plain
+     */
+    static MimeType GetFileType(std::string_view path);
+
+    /**
+     * 为缓存文件的一种编码生成 200 响应中不随时间变化的部分（状态行与 Date 之后的头部和内容），文件载入缓存时调用
+     */
+    static std::string Preserialize(const CachedFilePtr& file, int encoding, bool isKeepAlive);
+
+    static size_t compressMin;  /* 动态内容在线压缩的最小长度，0 表示不压缩 */
+
 private:
     void AddStateLine_(Buffer &buff);
     void AddHeader_(Buffer &buff);
     void AddContent_(Buffer &buff);
 
     void ErrorHtml_();
-    std::string GetFileType_();
+    /**
+     * 客户端是否能接收 chunked 编码（HTTP/1.1）
+     */
+    bool CanChunk_() const { return headers_.version == "1.1"; }
+    /**
+     * If-None-Match / If-Modified-Since 表明客户端缓存仍然有效，应回复 304
+     */
+    bool NotModified_() const;
+    /**
+     * 没有 If-Range，或其中的 ETag / 日期与当前文件一致，Range 才生效
+     */
+    bool IfRangeMatch_() const;
+    /**
+     * 按文件长度解析 Range 头：有可满足的区间时置 206，全部不可满足时置 416，
+     * 语法错误或区间过多时忽略 Range 头，保持 200 发送整个文件
+     */
+    void ParseRange_();
+    /**
+     * 生成 206 响应的 Content-type / Content-range / Content-length，多区间时同时生成各分段头部
+     */
+    void AddRangeHeader_(Buffer& buff);
+    /**
+     * 写入一个区间的 Content-range 头部行
+     */
+    void AppendRange_(Buffer& buff, const ByteRange& r) const;
+
+    /* 一个请求最多接受的区间数，防止大量小区间放大响应开销 */
+    static const size_t MAX_RANGES = 16;
 
     int code_;
+    int encoding_;
     bool isKeepAlive_;
+    bool preserialized_;
 
     std::string path_;
-    std::string srcDir_;
+    RequestHeaders headers_;
+    std::vector<ByteRange> ranges_;
+    std::string rangeTail_;
+    std::string body_;       /* 等待压缩的动态内容 */
+    std::string genMime_;
+    BodyGenerator generator_;
     
-    char* mmFile_; 
-    struct stat mmFileStat_;
-
-    static const std::unordered_map<std::string, std::string> SUFFIX_TYPE;
-    static const std::unordered_map<int, std::string> CODE_STATUS;
-    static const std::unordered_map<int, std::string> CODE_PATH;
+    CachedFilePtr file_;
 };
 
 
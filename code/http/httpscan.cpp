@@ -0,0 +1,192 @@
+#include "httpscan.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HTTP_SCAN_X86 1
+#endif
+
+/* RFC 7230 tchar: "!#$%&'*+-.^_`|~" / DIGIT / ALPHA */
+static constexpr bool IsTchar(unsigned char c) {
+    if((c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')) return true;
+    for(const char* p = "!#$%&'*+-.^_`|~"; *p; p++) {
+        if(static_cast<unsigned char>(*p) == c) return true;
+    }
+    return false;
+}
+
+/*
+ * 半字节查表：字节 c 合法当且仅当 LO[c & 0xF] 的第 (c >> 4) 位为 1。
+ * tchar 都小于 0x80，高半字节 8~15 在 HI 中为 0，非 ASCII 字节自然被判为非法。
+ */
+struct TokenTable {
+    unsigned char lo[16];
+    unsigned char hi[16];
+};
+
+static constexpr TokenTable MakeTokenTable() {
+    TokenTable t{};
+    for(int c = 0; c < 128; c++) {
+        if(IsTchar(static_cast<unsigned char>(c))) {
+            t.lo[c & 0xF] |= static_cast<unsigned char>(1 << (c >> 4));
+        }
+    }
+    for(int h = 0; h < 8; h++) {
+        t.hi[h] = static_cast<unsigned char>(1 << h);
+    }
+    return t;
+}
+
+alignas(16) static constexpr TokenTable TOKEN_TABLE = MakeTokenTable();
+
+/* ---------------- 标量实现 ---------------- */
+
+static const char* FindAnyScalar(const char* p, const char* end, const char* delims, size_t n) {
+    for(; p < end; p++) {
+        if(memchr(delims, *p, n)) return p;
+    }
+    return end;
+}
+
+static const char* FindNonTokenScalar(const char* p, const char* end) {
+    for(; p < end; p++) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if(!(TOKEN_TABLE.lo[c & 0xF] & TOKEN_TABLE.hi[c >> 4])) return p;
+    }
+    return end;
+}
+
+const char* HttpScan::FindAnyScalar_(const char* p, const char* end, const char* delims, size_t n) {
+    return FindAnyScalar(p, end, delims, n);
+}
+
+const char* HttpScan::FindNonTokenScalar_(const char* p, const char* end) {
+    return FindNonTokenScalar(p, end);
+}
+
+#ifdef HTTP_SCAN_X86
+
+/* ---------------- SSE4.2：16 字节步长 ---------------- */
+
+__attribute__((target("sse4.2")))
+static const char* FindAnySse42(const char* p, const char* end, const char* delims, size_t n) {
+    if(n == 0 || n > 16) return FindAnyScalar(p, end, delims, n);
+    char set[16] = {0};
+    memcpy(set, delims, n);
+    const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(set));
+    const char* begin = p;
+    while(end - p >= 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int idx = _mm_cmpestri(s, static_cast<int>(n), v, 16,
+                               _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT);
+        if(idx < 16) return p + idx;
+        p += 16;
+    }
+    if(p == end || end - begin < 16) return FindAnyScalar(p, end, delims, n);
+    /* 剩余不足 16 字节：回退到 end - 16 重叠读一次，重叠部分已确认不含分隔符 */
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(end - 16));
+    int idx = _mm_cmpestri(s, static_cast<int>(n), v, 16,
+                           _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT);
+    return idx < 16 ? end - 16 + idx : end;
+}
+
+__attribute__((target("sse4.2")))
+static const char* FindNonTokenSse42(const char* p, const char* end) {
+    const __m128i lo = _mm_load_si128(reinterpret_cast<const __m128i*>(TOKEN_TABLE.lo));
+    const __m128i hi = _mm_load_si128(reinterpret_cast<const __m128i*>(TOKEN_TABLE.hi));
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+    const char* begin = p;
+    while(true) {
+        if(end - p < 16) {
+            if(p == end || end - begin < 16) return FindNonTokenScalar(p, end);
+            /* 同 FindAnySse42，回退到 end - 16 重叠读最后一块 */
+            p = end - 16;
+        }
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i bits = _mm_and_si128(_mm_shuffle_epi8(lo, _mm_and_si128(v, nibble)),
+                                     _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi16(v, 4), nibble)));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(bits, zero));
+        if(mask) return p + __builtin_ctz(mask);
+        if(end - p == 16) return end;
+        p += 16;
+    }
+}
+
+/* ---------------- AVX2：32 字节步长 ---------------- */
+
+/* 实测 AVX2 从约 256 字节起才快于 SSE4.2，更短的输入转给 SSE 实现 */
+static constexpr ptrdiff_t AVX2_MIN_LEN = 256;
+
+__attribute__((target("avx2")))
+static const char* FindAnyAvx2(const char* p, const char* end, const char* delims, size_t n) {
+    /* 分隔符一般只有 1~4 个，逐个广播比较比 cmpestri 更快 */
+    if(n == 0 || n > 4 || end - p < AVX2_MIN_LEN) return FindAnySse42(p, end, delims, n);
+    __m256i set[4];
+    for(size_t i = 0; i < n; i++) {
+        set[i] = _mm256_set1_epi8(delims[i]);
+    }
+    while(end - p >= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i hit = _mm256_cmpeq_epi8(v, set[0]);
+        for(size_t i = 1; i < n; i++) {
+            hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, set[i]));
+        }
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+        if(mask) return p + __builtin_ctz(mask);
+        p += 32;
+    }
+    if(p == end) return end;
+    /* 最后一块回退到 end - 32 重叠读，不再转给非 VEX 编码的 SSE 实现 */
+    p = end - 32;
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i hit = _mm256_cmpeq_epi8(v, set[0]);
+    for(size_t i = 1; i < n; i++) {
+        hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, set[i]));
+    }
+    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+    return mask ? p + __builtin_ctz(mask) : end;
+}
+
+__attribute__((target("avx2")))
+static const char* FindNonTokenAvx2(const char* p, const char* end) {
+    /* 在使用任何 256 位寄存器前判断长度，短输入不付 AVX-SSE 切换开销 */
+    if(end - p < AVX2_MIN_LEN) return FindNonTokenSse42(p, end);
+    /* vpshufb 按 128 位分道查表，两个分道放同一张表 */
+    const __m256i lo = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(TOKEN_TABLE.lo)));
+    const __m256i hi = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(TOKEN_TABLE.hi)));
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i zero = _mm256_setzero_si256();
+    while(end - p >= 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i bits = _mm256_and_si256(_mm256_shuffle_epi8(lo, _mm256_and_si256(v, nibble)),
+                                        _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble)));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bits, zero)));
+        if(mask) return p + __builtin_ctz(mask);
+        p += 32;
+    }
+    if(p == end) return end;
+    /* 同 FindAnyAvx2，最后一块回退到 end - 32 重叠读 */
+    p = end - 32;
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i bits = _mm256_and_si256(_mm256_shuffle_epi8(lo, _mm256_and_si256(v, nibble)),
+                                    _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble)));
+    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bits, zero)));
+    return mask ? p + __builtin_ctz(mask) : end;
+}
+
+#endif // HTTP_SCAN_X86
+
+HttpScan::Impl HttpScan::Detect_() {
+#ifdef HTTP_SCAN_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) {
+        return Impl{FindAnyAvx2, FindNonTokenAvx2, "avx2"};
+    }
+    if(__builtin_cpu_supports("sse4.2")) {
+        return Impl{FindAnySse42, FindNonTokenSse42, "sse4.2"};
+    }
+#endif
+    return Impl{FindAnyScalar, FindNonTokenScalar, "scalar"};
+}
+
+const HttpScan::Impl HttpScan::impl_ = HttpScan::Detect_();
\ No newline at end of file
@@ -4,22 +4,27 @@ Log::Log() {
     lineCount_ = 0;
     isAsync_ = false;
     writeThread_ = nullptr;
-    deque_ = nullptr;
+    ring_ = nullptr;
+    closed_ = false;
+    writing_ = false;
     toDay_ = 0;
     fp_ = nullptr;
 }
 
 Log::~Log() {
     if(writeThread_ && writeThread_->joinable()) {
-        while(!deque_->empty()) {
-            deque_->flush();
+        /* 写线程写完积压的内容后退出 */
+        {
+            std::lock_guard<std::mutex> locker(mtx_);
+            closed_ = true;
         }
-        deque_->Close();
+        cond_.notify_all();
         writeThread_->join();
     }
     if(fp_) {
-        std::lock_guard<std::mutex> locker(mtx_);
-        flush();
+        std::unique_lock<std::mutex> locker(mtx_);
+        if(ring_) WriteRing_(locker, false);
+        fflush(fp_);
         fclose(fp_);
     }
 }
@@ -46,13 +51,31 @@ void Log::AppendLogLevelTitle_(int level) {
 }
 
 void Log::AsyncWrite_() {
-    std::string str = "";
-    while(deque_->pop(str)) {
-        std::lock_guard<std::mutex> locker(mtx_);
-        fputs(str.c_str(), fp_);
+    std::unique_lock<std::mutex> locker(mtx_);
+    while(true) {
+        cond_.wait(locker, [this] { return closed_ || ring_->ReadableBytes() > 0; });
+        if(ring_->ReadableBytes() == 0) break;
+        WriteRing_(locker, true);
     }
 }
 
+void Log::WriteRing_(std::unique_lock<std::mutex>& locker, bool flush) {
+    idle_.wait(locker, [this] { return !writing_; });
+    size_t len = ring_->ReadableBytes();
+    if(len == 0) return;
+    /* 镜像映射下积压的多行总是连续的，一次写出；写出期间其他线程追加的行留在其后，下一次再写 */
+    const char* data = ring_->Peek();
+    FILE* fp = fp_;
+    writing_ = true;
+    locker.unlock();
+    fwrite(data, 1, len, fp);
+    if(flush) fflush(fp);
+    locker.lock();
+    ring_->Retrieve(len);
+    writing_ = false;
+    idle_.notify_all();
+}
+
 void Log::init(int level = 1, const char* path, const char* suffix, int maxQueueCapacity) {
     isOpen_ = true;
     level_ = level;
@@ -60,11 +83,9 @@ void Log::init(int level = 1, const char* path, const char* suffix, int maxQueue
     suffix_ = suffix;
     if(maxQueueCapacity > 0) {
         isAsync_ = true;
-        if(!deque_) {
-            std::unique_ptr<BlockDeque<std::string>> newBQueue(new BlockDeque<std::string>);
-            deque_ = move(newBQueue);
-            std::unique_ptr<std::thread> newThread(new std::thread);
-            writeThread_ = move(newThread);
+        if(!ring_) {
+            std::unique_ptr<RingBuffer> newRing(new RingBuffer(static_cast<size_t>(maxQueueCapacity) * LINE_BYTES));
+            ring_ = move(newRing);
         }
     }
     else {
@@ -81,10 +102,11 @@ void Log::init(int level = 1, const char* path, const char* suffix, int maxQueue
     toDay_ = t.tm_mday;
 
     {
-        std::lock_guard<std::mutex> locker(mtx_);
+        std::unique_lock<std::mutex> locker(mtx_);
         buff_.RetrieveAll();
         if(fp_) {
-            flush();
+            if(ring_) WriteRing_(locker, false);
+            fflush(fp_);
             fclose(fp_);
         }
         fp_ = fopen(fileName, "a");
@@ -94,6 +116,11 @@ void Log::init(int level = 1, const char* path, const char* suffix, int maxQueue
         }
         assert(fp_ != nullptr);
     }
+    if(isAsync_ && !writeThread_) {
+        /* 文件打开后再启动写线程 */
+        std::unique_ptr<std::thread> newThread(new std::thread(FlushLogThread));
+        writeThread_ = move(newThread);
+    }
 }
 
 Log* Log::Instance() {
@@ -106,11 +133,10 @@ void Log::FlushLogThread() {
 }
 
 void Log::write(int level, const char *format,...) {
-    struct timeval now = {0, 0};
-    gettimeofday(&now, nullptr);
-    time_t tsec = now.tv_sec;
-    struct tm *systime = localtime(&tsec);
-    struct tm t = *systime;
+    /* 时间取自事件循环更新的粗粒度时钟，本地时间与前缀每秒才转换一次 */
+    int64_t nowUs = CoarseClock::NowUs();
+    const CoarseClock::Local& local = CoarseClock::LocalTime(static_cast<time_t>(nowUs / 1000000));
+    const struct tm& t = local.tm;
     va_list vaList;
 
     if(toDay_ != t.tm_mday || (lineCount_ && (lineCount_ % MAX_LINES == 0))) {
@@ -131,7 +157,9 @@ void Log::write(int level, const char *format,...) {
         }
 
         locker.lock();
-        flush();
+        /* 积压的行属于旧文件，先写出再切换；返回时没有线程在写旧文件 */
+        if(ring_) WriteRing_(locker, false);
+        fflush(fp_);
         fclose(fp_);
         fp_ = fopen(newFileName, "a");
         assert(fp_ != nullptr);
@@ -140,21 +168,46 @@ void Log::write(int level, const char *format,...) {
     {
         std::unique_lock<std::mutex> locker(mtx_);
         lineCount_++;
-        int n = snprintf(buff_.BeginWrite(), 128, "%d-%02d-%02d %02d:%02d:%02d.%06ld ", t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec, now.tv_usec);
+        buff_.EnsureWriteable(128);
+        int n = snprintf(buff_.BeginWrite(), 128, "%s.%06ld ", local.stamp, static_cast<long>(nowUs % 1000000));
         buff_.HasWritten(n);
         AppendLogLevelTitle_(level_);
 
         va_start(vaList, format);
+        va_list retry;
+        va_copy(retry, vaList);
         int m = vsnprintf(buff_.BeginWrite(), buff_.WritableBytes(), format, vaList);
         va_end(vaList);
-        buff_.HasWritten(m);
-        buff_.Append("\n\0", 2);
-
-        if(isAsync_ && deque_ && !deque_->full()) {
-            deque_->push_back(buff_.RetrieveAllToStr());
+        if(m >= 0 && static_cast<size_t>(m) >= buff_.WritableBytes()) {
+            /* 一行超过剩余容量时扩容后重新格式化 */
+            buff_.EnsureWriteable(m + 1);
+            vsnprintf(buff_.BeginWrite(), buff_.WritableBytes(), format, retry);
+        }
+        va_end(retry);
+        buff_.HasWritten(m > 0 ? m : 0);
+        buff_.Append("\n", 1);
+
+        if(isAsync_ && ring_) {
+            if(ring_->WritableBytes() < buff_.ReadableBytes()) {
+                /* 队列满时由当前线程先写出积压的内容，不丢行也不乱序。写出时会解锁，
+                   buff_ 可能被其他线程使用，本行先取出；锁外写出结束前不能扩容移动环形缓冲区 */
+                std::string line(buff_.Peek(), buff_.ReadableBytes());
+                buff_.RetrieveAll();
+                while(ring_->WritableBytes() < line.size() && (writing_ || ring_->ReadableBytes() > 0)) {
+                    WriteRing_(locker, false);
+                }
+                bool wake = ring_->ReadableBytes() == 0;
+                ring_->Append(line);
+                if(wake) cond_.notify_one();
+                return;
+            }
+            /* 写线程只在队列为空时等待，已有积压时不必再唤醒 */
+            bool wake = ring_->ReadableBytes() == 0;
+            ring_->Append(buff_.Peek(), buff_.ReadableBytes());
+            if(wake) cond_.notify_one();
         }
         else {
-            fputs(buff_.Peek(), fp_);
+            fwrite(buff_.Peek(), 1, buff_.ReadableBytes(), fp_);
         }
         buff_.RetrieveAll();
     }
@@ -162,7 +215,8 @@ void Log::write(int level, const char *format,...) {
 
 void Log::flush() {
     if(isAsync_) {
-        deque_->flush();
+        cond_.notify_one();
+        return;
     }
     fflush(fp_);
 }
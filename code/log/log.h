@@ -7,6 +7,8 @@
 #define LOG_H
 
 #include <mutex>
+#include <memory>
+#include <condition_variable>
 #include <string>
 #include <thread>
 #include <sys/time.h>
@@ -14,8 +16,9 @@
 #include <stdarg.h>           // vastart va_end
 #include <assert.h>
 #include <sys/stat.h>         //mkdir
-#include "blockqueue.h"
 #include "../buffer/buffer.h"
+#include "../buffer/ringbuffer.h"
+#include "../timer/coarseclock.h"
 
 class Log {
 public:
@@ -24,7 +27,7 @@ public:
      * @param level 日志等级（0-debug,1-info,2-warn,3-error）
      * @param path 日志文件目录
      * @param suffix 日志文件后缀
-     * @param maxQueueCapacity 异步队列最大容量
+     * @param maxQueueCapacity 异步队列最大容量（行数），大于 0 时启用异步写
      */
     void init(int level, const char* path = "./log", 
                 const char* suffix = ".log",
@@ -38,7 +41,7 @@ public:
 
     /**
      * 日志刷新线程入口函数（异步写日志时使用）
-     * 由后台线程调用，循环写入队列内容到文件
+     * 由后台线程调用，循环把环形缓冲区中积压的内容写入文件
      */
     static void FlushLogThread();
 
@@ -46,12 +49,12 @@ public:
      * 写日志，支持 printf 风格参数
      * @param level 日志等级（0-debug,1-info,2-warn,3-error）
      * @param format 格式化字符串
-     * @param ... 可变参数
+     * @param ... 可变参数（按 printf 规则由编译器检查类型）
      */
-    void write(int level, const char *format,...);
+    void write(int level, const char *format,...) __attribute__((format(printf, 3, 4)));
 
     /**
-     * 立即刷新缓冲区内容到磁盘文件
+     * 立即刷新缓冲区内容到磁盘文件；异步模式下唤醒写线程，由它写出后刷新
      */
     void flush();
 
@@ -92,14 +95,22 @@ private:
 
     /**
      * 异步写日志实现函数
-     * 从队列取出日志内容并写入文件
+     * 等待环形缓冲区中有数据，成批写入文件
      */
     void AsyncWrite_();
 
+    /**
+     * 把环形缓冲区中已有的内容写入当前文件：锁内取出连续的一段，解锁写文件，再加锁取走。
+     * 写出期间 writing_ 为真，其他线程要写出或关闭文件时先等待。返回时持有锁
+     * @param flush 写出后是否刷新文件
+     */
+    void WriteRing_(std::unique_lock<std::mutex>& locker, bool flush);
+
 private:
     static const int LOG_PATH_LEN = 256;
     static const int LOG_NAME_LEN = 256;
     static const int MAX_LINES = 50000;
+    static const int LINE_BYTES = 256;  /* 估算异步队列字节容量用的平均行长 */
 
     const char* path_;
     const char* suffix_;
@@ -116,9 +127,14 @@ private:
     bool isAsync_;
 
     FILE* fp_;
-    std::unique_ptr<BlockDeque<std::string>> deque_; 
+    /* 异步队列：格式化好的行追加到镜像环形缓冲区，写线程按连续的一段成批写出 */
+    std::unique_ptr<RingBuffer> ring_;
     std::unique_ptr<std::thread> writeThread_;
     std::mutex mtx_;
+    std::condition_variable cond_;
+    std::condition_variable idle_;   /* 锁外的写出结束时通知 */
+    bool writing_;   /* 有线程在锁外写出环形缓冲区的头部，期间只能追加不需要扩容的内容，不能关闭 fp_ */
+    bool closed_;
 };
 
 #define LOG_BASE(level, format, ...) \
@@ -25,7 +25,11 @@ int main(int argc, char* argv[]) {
     WebServer server(
         1214, 3, 60000, false,             /* 端口 ET模式 timeoutMs 优雅退出  */
         3306, "webserver", "111111", "webserver", /* Mysql配置 */
-        12, 6, openLog, 1, 1024);             /* 连接池数量 线程池数量 日志开关 日志等级 日志异步队列容量 */
+        12, 6, openLog, 1, 1024,             /* 连接池数量 静态道线程数 日志开关 日志等级 日志异步队列容量 */
+        0, false, false,                     /* Reactor 数量（0 表示单 Reactor + 线程池，N 表示 N 个 SO_REUSEPORT Reactor） 是否使用 io_uring 是否 run-to-completion */
+        1, 1024,                             /* 在线压缩线程数 动态内容压缩的最小长度（0 表示不压缩） */
+                                             /* 内置的错误页约 150 字节，不会被在线压缩；设置 HttpConn::handler 生成更长的动态内容后才会用到 */
+        4096, 4, 64);                        /* 静态道任务队列上限 数据库道线程数 数据库道任务队列上限 */
     server.Start();
 } 
   
\ No newline at end of file
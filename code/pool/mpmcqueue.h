@@ -0,0 +1,109 @@
+/*
+ * @Date         : 2026-10-18
+ * @copyleft Apache 2.0
+ */
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * MpmcQueue: 有界无锁多生产者多消费者环形队列（Vyukov 算法）。
+ * 每个槽位带一个序号，生产者与消费者各自用一次 CAS 认领位置，再以序号交接槽位，
+ * 元素按值存放在槽位中，入队出队都不分配内存。队列满时 TryPush 立即失败，由调用者决定如何处理。
+ */
+template<class T>
+class MpmcQueue {
+public:
+    /**
+     * @param capacity 容量，向上取整到 2 的幂
+     */
+    explicit MpmcQueue(size_t capacity): enqueuePos_(0), dequeuePos_(0) {
+        size_t cap = 2;
+        while(cap < capacity) cap <<= 1;
+        mask_ = cap - 1;
+        cells_.reset(new Cell[cap]);
+        for(size_t i = 0; i < cap; i++) cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    /**
+     * 入队，成功时 item 被移走，队列满时 item 保持不变
+     * @return 是否成功
+     */
+    bool TryPush(T& item) {
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while(true) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if(diff == 0) {
+                if(enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if(diff < 0) {
+                return false;
+            }
+            else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(item);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * 出队到 item
+     * @return 队列为空（或队头的元素还没写完）时返回 false
+     */
+    bool TryPop(T& item) {
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while(true) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if(diff == 0) {
+                if(dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            }
+            else if(diff < 0) {
+                return false;
+            }
+            else {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        item = std::move(cell->data);
+        cell->seq.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * 是否没有已认领入队位置的元素（并发下只是瞬时值）
+     */
+    bool Empty() const {
+        return enqueuePos_.load() == dequeuePos_.load();
+    }
+
+    size_t Capacity() const { return mask_ + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> enqueuePos_;
+    alignas(64) std::atomic<size_t> dequeuePos_;
+};
+
+#endif //MPMC_QUEUE_H
\ No newline at end of file
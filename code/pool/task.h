@@ -0,0 +1,109 @@
+/*
+ * @Date         : 2026-10-18
+ * @copyleft Apache 2.0
+ */
+#ifndef TASK_H
+#define TASK_H
+
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <stddef.h>
+
+/*
+ * Task: 只能移动的 void() 可调用对象，代替 std::function 作为线程池任务。
+ * 不超过 INLINE_SIZE 字节、可无异常移动的可调用对象（如绑定了成员函数、this 与连接指针的 std::bind）
+ * 直接存放在对象内部，不分配堆内存；更大的才放到堆上。
+ */
+class Task {
+public:
+    static const size_t INLINE_SIZE = 48;
+
+    Task() noexcept: ops_(nullptr) {}
+
+    template<class F, class = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+    Task(F&& fn) {
+        using Fn = std::decay_t<F>;
+        if constexpr(IsInline_<Fn>()) {
+            new (storage_) Fn(std::forward<F>(fn));
+            ops_ = &INLINE_OPS<Fn>;
+        }
+        else {
+            *reinterpret_cast<Fn**>(storage_) = new Fn(std::forward<F>(fn));
+            ops_ = &HEAP_OPS<Fn>;
+        }
+    }
+
+    Task(Task&& other) noexcept: ops_(other.ops_) {
+        if(ops_) {
+            ops_->move(storage_, other.storage_);
+            other.ops_ = nullptr;
+        }
+    }
+
+    Task& operator=(Task&& other) noexcept {
+        if(this != &other) {
+            Reset();
+            if(other.ops_) {
+                other.ops_->move(storage_, other.storage_);
+                ops_ = other.ops_;
+                other.ops_ = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() { Reset(); }
+
+    explicit operator bool() const { return ops_ != nullptr; }
+
+    void operator()() { ops_->invoke(storage_); }
+
+    /**
+     * 销毁持有的可调用对象
+     */
+    void Reset() {
+        if(ops_) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*move)(void* dst, void* src);   /* 移动到 dst 并销毁 src */
+        void (*destroy)(void* storage);
+    };
+
+    template<class Fn>
+    static constexpr bool IsInline_() {
+        return sizeof(Fn) <= INLINE_SIZE && alignof(Fn) <= alignof(void*)
+               && std::is_nothrow_move_constructible_v<Fn>;
+    }
+
+    template<class Fn>
+    static constexpr Ops INLINE_OPS = {
+        [](void* storage) { (*static_cast<Fn*>(storage))(); },
+        [](void* dst, void* src) {
+            new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+            static_cast<Fn*>(src)->~Fn();
+        },
+        [](void* storage) { static_cast<Fn*>(storage)->~Fn(); },
+    };
+
+    template<class Fn>
+    static constexpr Ops HEAP_OPS = {
+        [](void* storage) { (**static_cast<Fn**>(storage))(); },
+        [](void* dst, void* src) { *static_cast<Fn**>(dst) = *static_cast<Fn**>(src); },
+        [](void* storage) { delete *static_cast<Fn**>(storage); },
+    };
+
+    const Ops* ops_;
+    alignas(void*) unsigned char storage_[INLINE_SIZE];
+};
+
+#endif //TASK_H
\ No newline at end of file
@@ -7,30 +7,41 @@
 #ifndef THREADPOOL_H
 #define THREADPOOL_H
 
-#include <mutex>
-#include <condition_variable>
-#include <queue>
+#include <atomic>
+#include <memory>
+#include <vector>
 #include <thread>
-#include <functional>
+#include <assert.h>
+#include "task.h"
+#include "mpmcqueue.h"
+
+/*
+ * ThreadPool: 工作窃取线程池。
+ * 每个工作线程有一个有界无锁的 MPMC 任务队列，任务按值存放，提交与执行都不分配内存：
+ * 工作线程自己提交的任务压入自己的队列，Reactor 等外部线程的任务优先投给已休眠的线程，否则轮流投递。
+ * 工作线程先取自己的队列，取空后从其他线程的队列窃取，都取不到时先自旋让出若干轮，再在自己的状态字上休眠。
+ * 所有队列都满时按 FullPolicy 处理：阻塞等待、拒绝或由提交者自己执行。
+ * 析构时等待工作线程执行完已排队的任务后返回，任务引用的对象应在线程池之后销毁。
+ */
 class ThreadPool {
 public:
-    explicit ThreadPool(size_t threadCount = 8): pool_(std::make_shared<Pool>()) {
+    /* 所有队列都满时的处理方式 */
+    enum FullPolicy {
+        BLOCK,          /* 提交者让出 CPU 直到有空位（反压）；工作线程自己提交时改为 CALLER_RUNS，避免互相等待 */
+        REJECT,         /* AddTask 返回 false，由调用者处理 */
+        CALLER_RUNS,    /* 提交者在当前线程直接执行任务 */
+    };
+
+    /**
+     * @param threadCount 工作线程数
+     * @param queueCapacity 排队任务总数上限，平分给各工作线程的队列
+     * @param policy 队列满时的处理方式
+     */
+    explicit ThreadPool(size_t threadCount = 8, size_t queueCapacity = 4096, FullPolicy policy = BLOCK):
+            pool_(std::make_shared<Pool>(threadCount, queueCapacity, policy)) {
             assert(threadCount > 0);
             for(size_t i = 0; i < threadCount; i++) {
-                std::thread([pool = pool_] {
-                    std::unique_lock<std::mutex> locker(pool->mtx);
-                    while(true) {
-                        if(!pool->tasks.empty()) {
-                            auto task = std::move(pool->tasks.front());
-                            pool->tasks.pop();
-                            locker.unlock();
-                            task();
-                            locker.lock();
-                        } 
-                        else if(pool->isClosed) break;
-                        else pool->cond.wait(locker);
-                    }
-                }).detach();
+                threads_.emplace_back([pool = pool_, i] { Run_(pool, i); });
             }
     }
 
@@ -40,33 +51,194 @@ public:
     
     ~ThreadPool() {
         if(static_cast<bool>(pool_)) {
-            {
-                std::lock_guard<std::mutex> locker(pool_->mtx);
-                // 通知工作线程退出循环
-                pool_->isClosed = true;
+            // 通知工作线程执行完剩余任务后退出循环
+            pool_->isClosed.store(true);
+            for(size_t i = 0; i < pool_->num; i++) {
+                Worker& worker = *pool_->workers[i];
+                worker.state.store(RUNNING);
+                worker.state.notify_one();
             }
-            pool_->cond.notify_all();
+        }
+        /* 等待剩余任务执行完：任务捕获的 Reactor、HttpConn 等由调用者在此之后销毁 */
+        for(std::thread& t : threads_) {
+            assert(t.get_id() != std::this_thread::get_id());
+            t.join();
         }
     }
 
+    /**
+     * 提交任务
+     * @return 被 REJECT 策略拒绝时返回 false，任务不会执行
+     */
     template<class T>
-    void AddTask(T&& task) {
-        {
-            std::lock_guard<std::mutex> locker(pool_->mtx);
-            pool_->tasks.emplace(std::forward<T>(task));
-        }
-        pool_->cond.notify_one();
+    bool AddTask(T&& task) {
+        return Submit_(std::forward<T>(task), pool_->policy);
+    }
+
+    /**
+     * 提交任务，所有队列都满时不论 FullPolicy 如何都直接返回 false，不等待也不在当前线程执行。
+     * 用于可以放弃的后台任务，提交者（如 I/O 线程）不会被占满的队列拖住
+     */
+    template<class T>
+    bool TryAddTask(T&& task) {
+        return Submit_(std::forward<T>(task), REJECT);
     }
 
 private:
+    template<class T>
+    bool Submit_(T&& task, FullPolicy policy) {
+        Task item(std::forward<T>(task));
+        Pool& pool = *pool_;
+        Worker* self = current_ && current_->pool == &pool ? current_ : nullptr;
+        while(true) {
+            Worker* target = self ? self : &PickTarget_(pool);
+            if(Push_(pool, target, item)) {
+                /* 与 Park_ 配对：先公布任务再检查休眠状态 */
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                /* 自己队列里的任务有休眠的线程时唤醒一个来窃取 */
+                Wake_(pool, self ? nullptr : target);
+                return true;
+            }
+            if(policy == REJECT) return false;
+            if(policy == CALLER_RUNS || self) {
+                item();
+                return true;
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    enum State { RUNNING, PARKED };
+
+    struct Pool;
+    struct alignas(64) Worker {
+        Worker(Pool* owner, size_t index, size_t capacity): queue(capacity), pool(owner), idx(index) {}
+
+        MpmcQueue<Task> queue;
+        alignas(64) std::atomic<int> state{RUNNING};
+        Pool* const pool;
+        const size_t idx;
+    };
+
     struct Pool {
-        std::mutex mtx;
-        std::condition_variable cond;
-        // 标志线程池是否已关闭，true 表示不再接受新任务且线程应退出
-        bool isClosed;
-        std::queue<std::function<void()>> tasks;
+        Pool(size_t n, size_t capacity, FullPolicy fullPolicy): num(n), policy(fullPolicy) {
+            size_t perWorker = capacity / n > 0 ? capacity / n : 1;
+            for(size_t i = 0; i < n; i++) workers.emplace_back(new Worker(this, i, perWorker));
+        }
+
+        const size_t num;
+        const FullPolicy policy;
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::atomic<size_t> next{0};        /* 没有休眠线程时轮流投递 */
+        // 标志线程池是否已关闭，true 表示工作线程执行完剩余任务后退出
+        std::atomic<bool> isClosed{false};
     };
+
+    static const int SPIN_ROUNDS = 64;   /* 休眠前找不到任务时让出 CPU 的轮数 */
+
+    static void Run_(std::shared_ptr<Pool> pool, size_t idx) {
+        Worker& self = *pool->workers[idx];
+        current_ = &self;
+        Task task;
+        int idle = 0;
+        while(true) {
+            if(self.queue.TryPop(task) || Steal_(*pool, idx, task)) {
+                idle = 0;
+                task();
+                task.Reset();
+                continue;
+            }
+            if(pool->isClosed.load()) break;
+            if(++idle < SPIN_ROUNDS) {
+                std::this_thread::yield();
+                continue;
+            }
+            Park_(*pool, self);
+            idle = 0;
+        }
+        current_ = nullptr;
+    }
+
+    static bool Steal_(Pool& pool, size_t idx, Task& task) {
+        for(size_t k = 1; k < pool.num; k++) {
+            if(pool.workers[(idx + k) % pool.num]->queue.TryPop(task)) return true;
+        }
+        return false;
+    }
+
+    /**
+     * 从 target 开始依次尝试各工作线程的队列
+     * @param target 成功时为实际放入的队列所属的线程
+     */
+    static bool Push_(Pool& pool, Worker*& target, Task& item) {
+        for(size_t k = 0; k < pool.num; k++) {
+            Worker* worker = pool.workers[(target->idx + k) % pool.num].get();
+            if(worker->queue.TryPush(item)) {
+                target = worker;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static bool HasWork_(Pool& pool) {
+        for(size_t i = 0; i < pool.num; i++) {
+            if(!pool.workers[i]->queue.Empty()) return true;
+        }
+        return false;
+    }
+
+    static void Park_(Pool& pool, Worker& self) {
+        /* 先公布休眠再复查：提交者压入任务后检查状态，两边至少有一边能看到对方 */
+        self.state.store(PARKED);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(pool.isClosed.load() || HasWork_(pool)) {
+            self.state.store(RUNNING);
+            return;
+        }
+        while(self.state.load() == PARKED) {
+            self.state.wait(PARKED);
+        }
+    }
+
+    /**
+     * 外部提交的目标：优先选休眠中的线程，否则轮流
+     */
+    static Worker& PickTarget_(Pool& pool) {
+        size_t start = pool.next.fetch_add(1, std::memory_order_relaxed);
+        for(size_t k = 0; k < pool.num; k++) {
+            Worker& worker = *pool.workers[(start + k) % pool.num];
+            if(worker.state.load(std::memory_order_relaxed) == PARKED) return worker;
+        }
+        return *pool.workers[start % pool.num];
+    }
+
+    /**
+     * 唤醒 target（为空时唤醒任意一个）休眠中的线程；没有线程休眠时正在运行或自旋的线程会找到任务
+     */
+    static void Wake_(Pool& pool, Worker* target) {
+        if(target) {
+            Unpark_(*target);
+            return;
+        }
+        for(size_t i = 0; i < pool.num; i++) {
+            if(Unpark_(*pool.workers[i])) return;
+        }
+    }
+
+    static bool Unpark_(Worker& worker) {
+        int expected = PARKED;
+        if(worker.state.load() != PARKED || !worker.state.compare_exchange_strong(expected, RUNNING)) {
+            return false;
+        }
+        worker.state.notify_one();
+        return true;
+    }
+
+    static inline thread_local Worker* current_ = nullptr;   /* 当前线程所属的工作线程，非工作线程为空 */
+
     std::shared_ptr<Pool> pool_;
+    std::vector<std::thread> threads_;
 };
 
 
@@ -12,12 +12,13 @@
 #include <assert.h> // close()
 #include <vector>
 #include <errno.h>
+#include "poller.h"
 
-class Epoller {
+class Epoller : public Poller {
 public:
     explicit Epoller(int maxEvent = 1024);
 
-    ~Epoller();
+    ~Epoller() override;
 
     /**
      * 将 fd 添加到 epoll 实例并设置事件
@@ -25,34 +26,34 @@ public:
      * @param events 监听事件掩码（EPOLLIN | EPOLLOUT 等）
      * @return 是否添加成功
      */
-    bool AddFd(int fd, uint32_t events);
+    bool AddFd(int fd, uint32_t events) override;
 
     /**
      * 修改已注册 fd 的事件
      */
-    bool ModFd(int fd, uint32_t events);
+    bool ModFd(int fd, uint32_t events) override;
 
     /**
      * 从 epoll 中删除 fd
      */
-    bool DelFd(int fd);
+    bool DelFd(int fd) override;
 
     /**
      * 等待事件发生（封装 epoll_wait）
      * @param timeoutMs 超时时间（毫秒），-1 表示无限等待
      * @return 触发的事件数量
      */
-    int Wait(int timeoutMs = -1);
+    int Wait(int timeoutMs = -1) override;
 
     /**
      * 获取第 i 个事件对应的 fd
      */
-    int GetEventFd(size_t i) const;
+    int GetEventFd(size_t i) const override;
 
     /**
      * 获取第 i 个事件的事件标志位
      */
-    uint32_t GetEvents(size_t i) const;
+    uint32_t GetEvents(size_t i) const override;
         
 private:
     int epollFd_;
@@ -0,0 +1,106 @@
+/*
+ * @Date         : 2026-10-18
+ * @copyleft Apache 2.0
+ */
+#ifndef POLLER_H
+#define POLLER_H
+
+#include <sys/epoll.h> // EPOLLIN 等事件标志
+#include <sys/socket.h>  // accept4, recv
+#include <netinet/in.h>  // sockaddr_in
+#include <errno.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+
+/*
+ * Poller: 事件后端接口。事件掩码统一使用 EPOLL* 标志，
+ * 由 Epoller（epoll）与 UringPoller（io_uring）实现，启动时选择。
+ * 监听 socket 与已连接 socket 另有注册入口，完成式的后端（io_uring）可以代为 accept 与接收数据，
+ * 此时 Reactor 通过 Accept / Recv 取走结果；就绪式的后端使用默认实现，直接调用系统调用。
+ */
+class Poller {
+public:
+    virtual ~Poller() = default;
+
+    /**
+     * 将 fd 添加到后端并设置事件
+     * @param fd 文件描述符
+     * @param events 监听事件掩码（EPOLLIN | EPOLLOUT 等）
+     * @return 是否添加成功
+     */
+    virtual bool AddFd(int fd, uint32_t events) = 0;
+
+    /**
+     * 修改已注册 fd 的事件（EPOLLONESHOT 时用于重新武装）
+     */
+    virtual bool ModFd(int fd, uint32_t events) = 0;
+
+    /**
+     * 从后端删除 fd
+     */
+    virtual bool DelFd(int fd) = 0;
+
+    /**
+     * 注册监听 socket，可读事件到达后用 Accept 取新连接
+     */
+    virtual bool AddListen(int fd, uint32_t events) { return AddFd(fd, events); }
+
+    /**
+     * 注册已连接的 socket，可读事件到达后用 Recv 读取数据
+     */
+    virtual bool AddConn(int fd, uint32_t events) { return AddFd(fd, events); }
+
+    /**
+     * 取一个新连接（非阻塞）
+     * @param addr 对端地址；后端无法提供时 sin_family 为 AF_UNSPEC
+     * @return 新连接的 fd，没有时返回 -1 且 errno 为 EAGAIN
+     */
+    virtual int Accept(int listenFd, sockaddr_in* addr) {
+        socklen_t len = sizeof(*addr);
+        return accept4(listenFd, reinterpret_cast<sockaddr*>(addr), &len, SOCK_NONBLOCK);
+    }
+
+    /**
+     * 是否由后端代为接收已连接 socket 上的数据。是时必须用 Recv 读取，不能直接 read fd
+     */
+    virtual bool OwnsRecv() const { return false; }
+
+    /**
+     * 读出连接上已到达的全部数据，依次交给 sink
+     * @return 读出的字节数；对端已关闭时返回 0；暂无数据或出错时返回 -1，errno 见 saveErrno（EAGAIN 表示暂无数据）
+     */
+    virtual ssize_t Recv(int fd, const std::function<void(const char*, size_t)>& sink, int* saveErrno) {
+        char buff[16384];
+        ssize_t total = 0;
+        while(true) {
+            ssize_t len = recv(fd, buff, sizeof(buff), 0);
+            if(len <= 0) {
+                if(total > 0) return total;
+                *saveErrno = len < 0 ? errno : 0;
+                return len;
+            }
+            sink(buff, len);
+            total += len;
+        }
+    }
+
+    /**
+     * 等待事件发生
+     * @param timeoutMs 超时时间（毫秒），-1 表示无限等待
+     * @return 触发的事件数量
+     */
+    virtual int Wait(int timeoutMs = -1) = 0;
+
+    /**
+     * 获取第 i 个事件对应的 fd
+     */
+    virtual int GetEventFd(size_t i) const = 0;
+
+    /**
+     * 获取第 i 个事件的事件标志位
+     */
+    virtual uint32_t GetEvents(size_t i) const = 0;
+};
+
+#endif //POLLER_H
\ No newline at end of file
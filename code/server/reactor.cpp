@@ -0,0 +1,270 @@
+#include "reactor.h"
+
+Reactor::Reactor(HttpConn* users, int maxFd, int timeoutMS, uint32_t listenEvent, uint32_t connEvent,
+        const Lanes& lanes, bool inlineIO, bool ioUring):
+        timeoutMS_(timeoutMS), isClose_(false), listenFd_(-1), watchFd_(-1), watcher_(nullptr),
+        listenEvent_(listenEvent), connEvent_(connEvent), isUring_(false), inlineIO_(inlineIO),
+        lanes_(lanes), timer_(new HeapTimer()), users_(users), maxFd_(maxFd) {
+    assert(users_ && maxFd_ > 0 && lanes_[DB_LANE] && (inlineIO_ || lanes_[STATIC_LANE]));
+    if(ioUring) {
+        std::unique_ptr<UringPoller> uring(new UringPoller());
+        if(uring->IsValid()) {
+            poller_ = std::move(uring);
+            isUring_ = true;
+        }
+    }
+    if(!poller_) {
+        poller_.reset(new Epoller());
+    }
+}
+
+Reactor::~Reactor() {
+    isClose_ = true;
+    if(listenFd_ >= 0) close(listenFd_);
+}
+
+bool Reactor::AddListenFd(int listenFd) {
+    assert(listenFd >= 0);
+    if(!poller_->AddListen(listenFd, listenEvent_ | EPOLLIN)) {
+        return false;
+    }
+    listenFd_ = listenFd;
+    return true;
+}
+
+bool Reactor::AddWatcher(FileWatcher* watcher) {
+    assert(watcher && watcher->GetFd() >= 0);
+    if(!poller_->AddFd(watcher->GetFd(), EPOLLIN)) {
+        return false;
+    }
+    watcher_ = watcher;
+    watchFd_ = watcher->GetFd();
+    return true;
+}
+
+void Reactor::Stop() {
+    isClose_ = true;
+}
+
+void Reactor::Loop() {
+    loopThread_ = std::this_thread::get_id();
+    int timeMS = -1;
+    while(!isClose_) {
+        if(timeoutMS_ > 0) {
+            timeMS = timer_->GetNextTick();
+        }
+        int eventCnt = poller_->Wait(timeMS);
+        CoarseClock::Update();
+        for(int i = 0; i < eventCnt; i++) {
+            int fd = poller_->GetEventFd(i);
+            uint32_t events = poller_->GetEvents(i);
+            if(fd == listenFd_) {
+                DealListen_();
+            }
+            else if(fd == watchFd_) {
+                watcher_->OnEvent();
+            }
+            else if(events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                assert(fd < maxFd_);
+                CloseConn_(&users_[fd]);
+            }
+            else if(events & EPOLLIN) {
+                assert(fd < maxFd_);
+                DealRead_(&users_[fd]);
+            }
+            else if(events & EPOLLOUT) {
+                assert(fd < maxFd_);
+                DealWrite_(&users_[fd]);
+            }
+            else {
+                LOG_ERROR("Unexpected Event");
+            }
+        }
+    }
+}
+
+void Reactor::AddClient_(int fd, sockaddr_in addr) {
+    assert(fd > 0 && fd < maxFd_);
+    if(addr.sin_family != AF_INET && Log::Instance()->IsOpen()) {
+        /* io_uring 多发 accept 不带对端地址，只在需要写日志时补取 */
+        socklen_t len = sizeof(addr);
+        getpeername(fd, (sockaddr*)&addr, &len);
+    }
+    users_[fd].init(fd, addr);
+    if(timeoutMS_ > 0) {
+        timer_->add(fd, timeoutMS_, std::bind(&Reactor::OnTimeout_, this, &users_[fd], users_[fd].GetGen()));
+    }
+    /* 新连接由 Poller::Accept 以非阻塞方式接收 */
+    poller_->AddConn(fd, connEvent_ | EPOLLIN);
+    LOG_INFO("New Client[%d] in", users_[fd].GetFd());
+}
+
+void Reactor::DealListen_() {
+    sockaddr_in addr;
+    do {
+        int fd = poller_->Accept(listenFd_, &addr);
+        if(fd <= 0) return;
+        else if(fd >= maxFd_) {
+            SendError_(fd, "Server busy");
+            LOG_WARN("No Spare Client");
+            return;
+        }
+        AddClient_(fd, addr);
+    }while(listenEvent_ & EPOLLET);
+}
+
+void Reactor::DealRead_(HttpConn* client) {
+    assert(client);
+    ExtentTime_(client);
+    if(inlineIO_) {
+        OnRead_(client);
+    }
+    else {
+        if(!Submit_(STATIC_LANE, &Reactor::OnRead_, client)) CloseConn_(client);
+    }
+}
+
+void Reactor::DealWrite_(HttpConn* client) {
+    assert(client);
+    ExtentTime_(client);
+    if(inlineIO_) {
+        /* 写阻塞后的续写仍在本线程，连接停在事件循环里等待 EPOLLOUT，不占用工作线程 */
+        OnWrite_(client);
+    }
+    else {
+        if(!Submit_(STATIC_LANE, &Reactor::OnWrite_, client)) CloseConn_(client);
+    }
+}
+
+void Reactor::ExtentTime_(HttpConn* client) {
+    assert(client);
+    if(timeoutMS_ > 0) {
+        timer_->adjust(client->GetFd(), timeoutMS_);
+    }
+}
+
+void Reactor::CloseConn_(HttpConn* client) {
+    assert(client);
+    LOG_INFO("Client[%d] quit!", client->GetFd());
+    if(timeoutMS_ > 0 && std::this_thread::get_id() == loopThread_) {
+        /* 线程池中关闭时不能访问定时器，留下的过期项由 OnTimeout_ 按代数识别 */
+        timer_->del(client->GetFd());
+    }
+    poller_->DelFd(client->GetFd());
+    client->Close();
+}
+
+void Reactor::OnTimeout_(HttpConn* client, uint32_t gen) {
+    assert(client);
+    if(client->GetGen() != gen) return;
+    CloseConn_(client);
+}
+
+void Reactor::SendError_(int fd, const char* info) {
+    assert(fd > 0);
+    int ret = send(fd, info, strlen(info), 0);
+    if(ret < 0) {
+        LOG_WARN("Send Error to Client[%d] Failed", fd);
+    }
+    close(fd);
+}
+
+static const char* LANE_NAMES[Reactor::LANE_NUM] = {"static", "db", "compress"};
+
+bool Reactor::Submit_(Lane lane, void (Reactor::*handler)(HttpConn*), HttpConn* client) {
+    assert(lanes_[lane] && client);
+    if(lanes_[lane]->AddTask(std::bind(handler, this, client))) return true;
+    LOG_WARN("%s lane full, Client[%d]", LANE_NAMES[lane], client->GetFd());
+    return false;
+}
+
+void Reactor::OnRead_(HttpConn* client) {
+    assert(client);
+    int ret = -1;
+    int readErrno = 0;
+    if(poller_->OwnsRecv()) {
+        /* 数据已由 io_uring 收进缓冲区环，拷入连接的读缓冲区 */
+        ret = poller_->Recv(client->GetFd(), [client](const char* data, size_t len) { client->AppendRead(data, len); },
+                            &readErrno);
+    }
+    else {
+        ret = client->read(&readErrno);
+    }
+    if(ret <= 0 && readErrno != EAGAIN) {
+        CloseConn_(client);
+        return;
+    }
+    OnProcess(client);
+}
+
+void Reactor::OnWrite_(HttpConn* client) {
+    assert(client);
+    int ret = -1;
+    int writeErrno = 0;
+    ret = client->write(&writeErrno);
+    if(client->ToWriteBytes() == 0) {
+        if(client->IsKeepAlive()) {
+            OnProcess(client);
+            return;
+        }
+    }
+    else if(ret > 0 || writeErrno == EAGAIN) {
+        /* 发送缓冲区已满，或水平触发下本轮写够了，剩余部分（含 sendfile 的偏移）等 EPOLLOUT 后续传 */
+        poller_->ModFd(client->GetFd(), connEvent_ | EPOLLOUT);
+        return;
+    }
+    CloseConn_(client);
+}
+
+void Reactor::OnProcess(HttpConn* client) {
+    assert(client);
+    /* 流水线中的请求逐个解析，响应按顺序排入同一个输出队列 */
+    while(client->CanPipeline() && client->Parse()) {
+        if(client->IsBlocking()) {
+            /* 阻塞请求的响应由 DB 道追加在已排队响应之后，顺序不变 */
+            if(Submit_(DB_LANE, &Reactor::OnRespond_, client)) return;
+            /* DB 道已满：回复 503 并在发送后关闭，不等待也不占用当前线程 */
+            client->Reject();
+            break;
+        }
+        client->Respond();
+        if(client->NeedCompress()) {
+            /* 已排队的头部与之前的响应等压缩完成后一起写出 */
+            if(!Submit_(COMPRESS_LANE, &Reactor::OnCompress_, client)) CloseConn_(client);
+            return;
+        }
+    }
+    if(client->ToWriteBytes() == 0) {
+        /* 空闲的长连接不持有缓冲区内存 */
+        client->ReleaseBuffers();
+        poller_->ModFd(client->GetFd(), connEvent_ | EPOLLIN);
+        return;
+    }
+    if(!inlineIO_) {
+        poller_->ModFd(client->GetFd(), connEvent_ | EPOLLOUT);
+        return;
+    }
+    /* 静态请求直接在本线程尝试首次 writev，写不完时 OnWrite_ 注册 EPOLLOUT */
+    OnWrite_(client);
+}
+
+void Reactor::OnRespond_(HttpConn* client) {
+    assert(client);
+    client->Respond();
+    if(client->NeedCompress()) {
+        if(!Submit_(COMPRESS_LANE, &Reactor::OnCompress_, client)) CloseConn_(client);
+        return;
+    }
+    poller_->ModFd(client->GetFd(), connEvent_ | EPOLLOUT);
+}
+
+void Reactor::OnCompress_(HttpConn* client) {
+    assert(client && lanes_[COMPRESS_LANE]);
+    client->CompressBody();
+    poller_->ModFd(client->GetFd(), connEvent_ | EPOLLOUT);
+}
+
+int Reactor::SetFdNonblock(int fd) {
+    assert(fd > 0);
+    return fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
\ No newline at end of file
@@ -0,0 +1,169 @@
+/*
+ * @Date         : 2026-10-18
+ * @copyleft Apache 2.0
+ */
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <fcntl.h>       // fcntl()
+#include <unistd.h>      // close()
+#include <assert.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <array>
+#include <thread>
+
+#include "epoller.h"
+#include "uringpoller.h"
+#include "../log/log.h"
+#include "../timer/heaptimer.h"
+#include "../pool/threadpool.h"
+#include "../http/httpconn.h"
+#include "../http/filewatcher.h"
+
+/*
+ * Reactor: 一个事件循环，独占自己的 Poller 与 HeapTimer。
+ * 连接槽位表按 fd 下标由所有 Reactor 共享，fd 在进程内唯一，故每个槽位只被接收它的 Reactor 访问。
+ * inlineIO 为 false 时读写都交给 STATIC 道的线程池；为 true 时（run-to-completion，多 Reactor 默认）
+ * 读取、解析、生成响应和首次 writev 都在本线程完成。
+ * 两种模式下都按路由给请求分道：需要数据库校验的交给 DB 道，需要在线压缩的动态内容交给 COMPRESS 道。
+ */
+class Reactor {
+public:
+    /* 线程池分道：各道线程数与队列上限互相独立，数据库变慢只会占满 DB 道，不会拖住处理静态请求的线程 */
+    enum Lane {
+        STATIC_LANE,    /* 读写与非阻塞请求（reactor + 线程池模式），inlineIO 时为空 */
+        DB_LANE,        /* 需要数据库校验的请求 */
+        COMPRESS_LANE,  /* 动态内容在线压缩，关闭在线压缩时为空 */
+        LANE_NUM,
+    };
+    typedef std::array<ThreadPool*, LANE_NUM> Lanes;
+
+    /**
+     * @param users 预分配的连接槽位表（按 fd 下标）
+     * @param maxFd 槽位数量，fd >= maxFd 的连接会被拒绝
+     * @param lanes 各道的线程池
+     * @param inlineIO 是否在 Reactor 线程内完成非阻塞请求（run-to-completion）
+     * @param ioUring 是否使用 io_uring 事件后端（内核不支持时回退到 epoll）
+     */
+    Reactor(HttpConn* users, int maxFd, int timeoutMS, uint32_t listenEvent, uint32_t connEvent,
+            const Lanes& lanes, bool inlineIO, bool ioUring = false);
+
+    ~Reactor();
+
+    /**
+     * 注册监听 socket，由本 Reactor 负责 accept
+     * @return 是否注册成功
+     */
+    bool AddListenFd(int listenFd);
+
+    /**
+     * 注册资源目录监视器，其 inotify fd 由本 Reactor 的事件循环处理
+     * @return 是否注册成功
+     */
+    bool AddWatcher(FileWatcher* watcher);
+
+    /**
+     * 运行事件循环，直到 Stop 被调用
+     */
+    void Loop();
+
+    /**
+     * 请求事件循环退出
+     */
+    void Stop();
+
+    /**
+     * 实际使用的事件后端名称
+     */
+    const char* PollerName() const { return isUring_ ? "io_uring" : "epoll"; }
+
+    static int SetFdNonblock(int fd);
+
+private:
+    /**
+     * 新客户端接入时添加到连接表并注册定时器
+     */
+    void AddClient_(int fd, sockaddr_in addr);
+
+    /**
+     * 处理监听套接字上的可读事件（accept 新连接）
+     */
+    void DealListen_();
+    /**
+     * 处理写事件：将待写数据发送到客户端
+     */
+    void DealWrite_(HttpConn* client);
+    /**
+     * 处理读事件：读取并解析请求
+     */
+    void DealRead_(HttpConn* client);
+
+    /**
+     * 向 fd 发送错误信息并关闭连接
+     */
+    void SendError_(int fd, const char*info);
+    /**
+     * 扩展客户端定时器（重置超时时间）
+     */
+    void ExtentTime_(HttpConn* client);
+    /**
+     * 关闭客户端连接并清理资源
+     */
+    void CloseConn_(HttpConn* client);
+    /**
+     * 连接超时回调
+     * @param gen 注册定时器时槽位的代数，不一致说明连接已关闭且 fd 被重新接收（可能属于另一个 Reactor）
+     */
+    void OnTimeout_(HttpConn* client, uint32_t gen);
+
+    /**
+     * 把连接的处理函数交给 lane 道的线程池
+     * @return 线程池按 REJECT 策略拒绝时返回 false
+     */
+    bool Submit_(Lane lane, void (Reactor::*handler)(HttpConn*), HttpConn* client);
+
+    /**
+     * 读事件的高层回调：从 socket 读取数据并准备处理
+     */
+    void OnRead_(HttpConn* client);
+    /**
+     * 写事件的高层回调：处理写完成或继续写入
+     */
+    void OnWrite_(HttpConn* client);
+    /**
+     * 处理完成回调：执行请求处理逻辑
+     */
+    void OnProcess(HttpConn* client);
+    /**
+     * 线程池中执行阻塞的响应生成（数据库校验），完成后交回事件循环写出
+     */
+    void OnRespond_(HttpConn* client);
+    /**
+     * 压缩线程池中压缩动态内容，完成后交回事件循环写出
+     */
+    void OnCompress_(HttpConn* client);
+
+    int timeoutMS_;  /* 毫秒MS */
+    std::atomic<bool> isClose_;
+    std::thread::id loopThread_;  /* 运行事件循环的线程，定时器只在该线程内访问 */
+    int listenFd_;
+    int watchFd_;
+    FileWatcher* watcher_;
+
+    uint32_t listenEvent_;
+    uint32_t connEvent_;
+
+    bool isUring_;
+    bool inlineIO_;
+
+    Lanes lanes_;
+    std::unique_ptr<HeapTimer> timer_;
+    std::unique_ptr<Poller> poller_;
+    HttpConn* users_;
+    int maxFd_;
+};
+
+#endif //REACTOR_H
\ No newline at end of file
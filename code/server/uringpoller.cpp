@@ -0,0 +1,553 @@
+#include "uringpoller.h"
+
+UringPoller::UringPoller(unsigned entries, int maxEvent):
+        ringFd_(-1), ringPtr_(MAP_FAILED), ringSize_(0), sqes_(nullptr), sqesSize_(0), sqeTail_(0),
+        bufRing_(nullptr), bufBase_(nullptr), bufTail_(0), bufHeld_(0),
+        recvMultishot_(true), acceptMultishot_(true), events_(maxEvent) {
+    assert(entries > 0 && events_.size() > 0);
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    /* 每个连接都可能挂着一个 RECV 或 POLL_ADD，完成队列按连接数放大 */
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+    params.cq_entries = 65536;
+    int fd = syscall(__NR_io_uring_setup, entries, &params);
+    if(fd < 0) return;
+    if(!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_EXT_ARG)) {
+        close(fd);
+        return;
+    }
+
+    size_t sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    ringSize_ = sqSize > cqSize ? sqSize : cqSize;
+    ringPtr_ = mmap(nullptr, ringSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if(ringPtr_ == MAP_FAILED) {
+        close(fd);
+        return;
+    }
+    sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if(sqes == MAP_FAILED) {
+        munmap(ringPtr_, ringSize_);
+        ringPtr_ = MAP_FAILED;
+        close(fd);
+        return;
+    }
+    sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+    char* ring = static_cast<char*>(ringPtr_);
+    sqHead_ = reinterpret_cast<unsigned*>(ring + params.sq_off.head);
+    sqTail_ = reinterpret_cast<unsigned*>(ring + params.sq_off.tail);
+    sqArray_ = reinterpret_cast<unsigned*>(ring + params.sq_off.array);
+    sqMask_ = *reinterpret_cast<unsigned*>(ring + params.sq_off.ring_mask);
+    sqEntries_ = params.sq_entries;
+    sqeTail_ = *sqTail_;
+
+    cqHead_ = reinterpret_cast<unsigned*>(ring + params.cq_off.head);
+    cqTail_ = reinterpret_cast<unsigned*>(ring + params.cq_off.tail);
+    cqMask_ = *reinterpret_cast<unsigned*>(ring + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(ring + params.cq_off.cqes);
+
+    ringFd_ = fd;
+    /* 注册失败（内核早于 5.19）时连接退回 POLL_ADD + recv */
+    SetupBufRing_();
+}
+
+UringPoller::~UringPoller() {
+    if(bufRing_) munmap(bufRing_, BUF_NUM * sizeof(io_uring_buf));
+    if(bufBase_) munmap(bufBase_, static_cast<size_t>(BUF_NUM) * BUF_SIZE);
+    if(sqes_) munmap(sqes_, sqesSize_);
+    if(ringPtr_ != MAP_FAILED) munmap(ringPtr_, ringSize_);
+    if(ringFd_ >= 0) close(ringFd_);
+}
+
+bool UringPoller::SetupBufRing_() {
+    void* ring = mmap(nullptr, BUF_NUM * sizeof(io_uring_buf), PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if(ring == MAP_FAILED) return false;
+    void* base = mmap(nullptr, static_cast<size_t>(BUF_NUM) * BUF_SIZE, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(base == MAP_FAILED) {
+        munmap(ring, BUF_NUM * sizeof(io_uring_buf));
+        return false;
+    }
+    io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<uint64_t>(ring);
+    reg.ring_entries = BUF_NUM;
+    reg.bgid = BUF_GROUP;
+    if(syscall(__NR_io_uring_register, ringFd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        munmap(ring, BUF_NUM * sizeof(io_uring_buf));
+        munmap(base, static_cast<size_t>(BUF_NUM) * BUF_SIZE);
+        return false;
+    }
+    bufRing_ = static_cast<io_uring_buf_ring*>(ring);
+    bufBase_ = static_cast<char*>(base);
+    bufHeld_ = BUF_NUM;
+    for(unsigned i = 0; i < BUF_NUM; i++) RecycleBuf_(i);
+    PublishBufs_();
+    return true;
+}
+
+bool UringPoller::AddFd(int fd, uint32_t events) {
+    if(fd < 0) return false;
+    {
+        std::lock_guard<std::mutex> locker(mtx_);
+        Reset_(fd);
+        FdState& st = fds_[fd];
+        st.events = events;
+        PrepPoll_(fd);
+    }
+    FlushIfForeign_();
+    return true;
+}
+
+bool UringPoller::AddListen(int fd, uint32_t events) {
+    if(!acceptMultishot_) return AddFd(fd, events);
+    if(fd < 0) return false;
+    {
+        std::lock_guard<std::mutex> locker(mtx_);
+        Reset_(fd);
+        FdState& st = fds_[fd];
+        st.kind = LISTEN_FD;
+        st.events = events;
+        PrepAccept_(fd);
+    }
+    FlushIfForeign_();
+    return true;
+}
+
+bool UringPoller::AddConn(int fd, uint32_t events) {
+    if(!bufRing_ || !recvMultishot_) return AddFd(fd, events);
+    if(fd < 0) return false;
+    {
+        std::lock_guard<std::mutex> locker(mtx_);
+        Reset_(fd);
+        fds_[fd].kind = CONN_FD;
+        TryRecv_(fd);
+    }
+    return ModFd(fd, events);
+}
+
+bool UringPoller::ModFd(int fd, uint32_t events) {
+    if(fd < 0) return false;
+    {
+        std::lock_guard<std::mutex> locker(mtx_);
+        FdState& st = State_(fd);
+        if(st.kind == LISTEN_FD) {
+            st.events = events;
+            return true;
+        }
+        if(st.armed) {
+            PrepCancel_(OP_POLL, fd, st.pollGen);
+            st.armed = false;
+        }
+        st.pollGen++;
+        st.events = events;
+        if(st.kind == CONN_FD) {
+            /* 读事件由 RECV 的完成驱动，重新武装只改状态；已有数据时直接上报 */
+            st.inArmed = events & EPOLLIN;
+            MarkIn_(fd);
+            if(events & EPOLLOUT) PrepPoll_(fd);
+        }
+        else {
+            PrepPoll_(fd);
+        }
+    }
+    FlushIfForeign_();
+    return true;
+}
+
+bool UringPoller::DelFd(int fd) {
+    if(fd < 0) return false;
+    {
+        std::lock_guard<std::mutex> locker(mtx_);
+        Reset_(fd);
+    }
+    FlushIfForeign_();
+    return true;
+}
+
+int UringPoller::Accept(int listenFd, sockaddr_in* addr) {
+    {
+        std::lock_guard<std::mutex> locker(mtx_);
+        if(static_cast<size_t>(listenFd) < fds_.size() && fds_[listenFd].kind == LISTEN_FD) {
+            for(auto it = accepted_.begin(); it != accepted_.end(); ++it) {
+                if(it->first != listenFd) continue;
+                int fd = it->second;
+                accepted_.erase(it);
+                /* 多发 ACCEPT 共用一个地址缓冲区，无法给出每个连接的对端地址 */
+                memset(addr, 0, sizeof(*addr));
+                addr->sin_family = AF_UNSPEC;
+                return fd;
+            }
+            errno = EAGAIN;
+            return -1;
+        }
+    }
+    return Poller::Accept(listenFd, addr);
+}
+
+ssize_t UringPoller::Recv(int fd, const std::function<void(const char*, size_t)>& sink, int* saveErrno) {
+    assert(saveErrno);
+    std::unique_lock<std::mutex> locker(mtx_);
+    if(static_cast<size_t>(fd) >= fds_.size() || fds_[fd].kind != CONN_FD) {
+        /* 退回 POLL_ADD 的连接直接 recv */
+        locker.unlock();
+        return Poller::Recv(fd, sink, saveErrno);
+    }
+    FdState& st = fds_[fd];
+    if(st.heldNum == 0) {
+        *saveErrno = st.err ? st.err : (st.eof ? 0 : EAGAIN);
+        return st.eof && !st.err ? 0 : -1;
+    }
+    ssize_t total = 0;
+    while(st.heldHead != NO_BUF) {
+        uint16_t bid = st.heldHead;
+        st.heldHead = bufNext_[bid];
+        sink(bufBase_ + static_cast<size_t>(bid) * BUF_SIZE, bufLen_[bid]);
+        total += bufLen_[bid];
+        RecycleBuf_(bid);
+    }
+    st.heldTail = NO_BUF;
+    st.heldNum = 0;
+    PublishBufs_();
+    TryRecv_(fd);
+    locker.unlock();
+    FlushIfForeign_();
+    return total;
+}
+
+int UringPoller::Wait(int timeoutMs) {
+    loopThread_ = std::this_thread::get_id();
+    unsigned toSubmit;
+    {
+        std::lock_guard<std::mutex> locker(mtx_);
+        /* 未设置 EPOLLONESHOT 的 fd（如 inotify）与结束了的多发 ACCEPT 在此处重新提交 */
+        for(size_t i = 0; i < rearm_.size(); i++) {
+            int fd = rearm_[i];
+            FdState& st = fds_[fd];
+            if(st.kind == LISTEN_FD && !st.multishot) PrepAccept_(fd);
+            else if(st.kind == POLL_FD && st.events && !st.armed) PrepPoll_(fd);
+        }
+        rearm_.clear();
+        /* 水平触发：还有未取走的新连接时继续上报监听 socket 可读 */
+        for(const auto& conn : accepted_) MarkReady_(conn.first, EPOLLIN);
+        Reap_();
+        if(!ready_.empty()) timeoutMs = 0;
+        toSubmit = Pending_();
+    }
+
+    __kernel_timespec ts = { timeoutMs / 1000, (timeoutMs % 1000) * 1000000LL };
+    /* 其他线程在解锁后追加并自行提交的请求会让内核少交几个，此时 enter 不等待直接返回，只是一次空唤醒 */
+    int ret = Enter_(toSubmit, timeoutMs == 0 ? 0 : 1, IORING_ENTER_GETEVENTS, timeoutMs >= 0 ? &ts : nullptr);
+    if(ret < 0 && errno != ETIME && errno != EINTR) {
+        if(errno != EBUSY && errno != EAGAIN) return -1;
+        /* 完成队列溢出（EBUSY）或内核暂时无法分配请求：收割完成队列后再让内核把溢出的事件搬进来，
+           未提交的请求仍在提交队列中，下一次 Wait 重新提交 */
+        std::lock_guard<std::mutex> locker(mtx_);
+        Reap_();
+        Enter_(Pending_(), 0, IORING_ENTER_GETEVENTS, nullptr);
+    }
+
+    std::lock_guard<std::mutex> locker(mtx_);
+    Reap_();
+    size_t cnt = 0, i = 0;
+    for(; i < ready_.size() && cnt < events_.size(); i++) {
+        FdState& st = fds_[ready_[i]];
+        if(!st.ready) continue;
+        st.ready = false;
+        if(!st.revents) continue;
+        events_[cnt].data.fd = ready_[i];
+        events_[cnt].events = st.revents;
+        st.revents = 0;
+        cnt++;
+    }
+    ready_.erase(ready_.begin(), ready_.begin() + i);
+    return static_cast<int>(cnt);
+}
+
+int UringPoller::GetEventFd(size_t i) const {
+    assert(i < events_.size());
+    return events_[i].data.fd;
+}
+
+uint32_t UringPoller::GetEvents(size_t i) const {
+    assert(i < events_.size());
+    return events_[i].events;
+}
+
+void UringPoller::Reap_() {
+    /* 先复制并消费再处理：处理中补交请求遇到 EBUSY 会重入 Reap_，从更新后的队首继续 */
+    unsigned head;
+    while((head = *cqHead_) != __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) {
+        const io_uring_cqe cqe = cqes_[head & cqMask_];
+        __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+        Op op = static_cast<Op>(cqe.user_data >> 56);
+        int fd = static_cast<int>(cqe.user_data & 0xffffffffu);
+        uint32_t gen = static_cast<uint32_t>(cqe.user_data >> 32) & GEN_MASK;
+        bool valid = op != OP_IGNORE && fd >= 0 && static_cast<size_t>(fd) < fds_.size();
+        if(op == OP_POLL) {
+            if(!valid || (fds_[fd].pollGen & GEN_MASK) != gen) continue;
+            FdState& st = fds_[fd];
+            st.armed = false;
+            if(cqe.res < 0) continue;
+            MarkReady_(fd, static_cast<uint32_t>(cqe.res));
+            if(!(st.events & EPOLLONESHOT)) rearm_.push_back(fd);
+        }
+        else if(op == OP_RECV) {
+            if(!valid || (fds_[fd].gen & GEN_MASK) != gen || fds_[fd].kind != CONN_FD) {
+                /* 连接已删除：归还过期的完成事件带回的缓冲区 */
+                if(cqe.flags & IORING_CQE_F_BUFFER) {
+                    bufHeld_++;
+                    RecycleBuf_(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+                    PublishBufs_();
+                }
+                continue;
+            }
+            OnRecv_(fd, cqe);
+        }
+        else if(op == OP_ACCEPT) {
+            if(!valid || (fds_[fd].gen & GEN_MASK) != gen || fds_[fd].kind != LISTEN_FD) {
+                if(cqe.res >= 0) close(cqe.res);
+                continue;
+            }
+            OnAccept_(fd, cqe);
+        }
+    }
+}
+
+void UringPoller::OnRecv_(int fd, const io_uring_cqe& cqe) {
+    FdState& st = fds_[fd];
+    if(!(cqe.flags & IORING_CQE_F_MORE)) {
+        st.multishot = false;
+        st.cancelling = false;
+    }
+    if(cqe.flags & IORING_CQE_F_BUFFER) {
+        uint16_t bid = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+        bufHeld_++;
+        if(cqe.res > 0) {
+            bufLen_[bid] = cqe.res;
+            bufNext_[bid] = NO_BUF;
+            if(st.heldTail == NO_BUF) st.heldHead = bid;
+            else bufNext_[st.heldTail] = bid;
+            st.heldTail = bid;
+            st.heldNum++;
+        }
+        else {
+            RecycleBuf_(bid);
+            PublishBufs_();
+        }
+    }
+    if(cqe.res == 0) {
+        st.eof = true;
+    }
+    else if(cqe.res == -EINVAL && !st.heldNum && !(cqe.flags & IORING_CQE_F_MORE)) {
+        /* 内核不支持多发 recv（早于 6.0）：之后的连接与本连接都退回 POLL_ADD + recv */
+        recvMultishot_ = false;
+        st.kind = POLL_FD;
+        st.inArmed = false;
+        PrepPoll_(fd);
+        return;
+    }
+    else if(cqe.res == -ENOBUFS) {
+        /* 缓冲区环已空：等有缓冲区归还时再提交，避免立即重试空转 */
+        if(!st.starved) {
+            st.starved = true;
+            starved_.push_back(fd);
+        }
+    }
+    else if(cqe.res < 0 && cqe.res != -ECANCELED) {
+        st.err = -cqe.res;
+    }
+    if(st.multishot && !st.cancelling && st.heldNum >= MAX_HELD) {
+        PrepCancel_(OP_RECV, fd, st.gen);
+        st.cancelling = true;
+    }
+    if(!st.multishot) TryRecv_(fd);
+    MarkIn_(fd);
+}
+
+void UringPoller::OnAccept_(int fd, const io_uring_cqe& cqe) {
+    FdState& st = fds_[fd];
+    if(!(cqe.flags & IORING_CQE_F_MORE)) {
+        st.multishot = false;
+        if(cqe.res == -EINVAL) {
+            /* 内核不支持多发 accept（早于 5.19）：监听 socket 退回 POLL_ADD + accept */
+            acceptMultishot_ = false;
+            st.kind = POLL_FD;
+            PrepPoll_(fd);
+            return;
+        }
+        rearm_.push_back(fd);
+    }
+    if(cqe.res >= 0) {
+        accepted_.emplace_back(fd, cqe.res);
+        MarkReady_(fd, EPOLLIN);
+    }
+}
+
+void UringPoller::MarkReady_(int fd, uint32_t revents) {
+    FdState& st = fds_[fd];
+    st.revents |= revents;
+    if(!st.ready) {
+        st.ready = true;
+        ready_.push_back(fd);
+    }
+}
+
+void UringPoller::MarkIn_(int fd) {
+    FdState& st = fds_[fd];
+    if(!st.inArmed || (!st.heldNum && !st.eof && !st.err)) return;
+    MarkReady_(fd, EPOLLIN | (st.eof ? static_cast<uint32_t>(EPOLLRDHUP) : 0u) | (st.err ? static_cast<uint32_t>(EPOLLERR) : 0u));
+    if(st.events & EPOLLONESHOT) st.inArmed = false;
+}
+
+void UringPoller::TryRecv_(int fd) {
+    FdState& st = fds_[fd];
+    if(st.kind != CONN_FD || st.multishot || st.eof || st.err || st.heldNum >= MAX_HELD) return;
+    if(st.starved || bufHeld_ >= BUF_NUM) {
+        if(!st.starved) {
+            st.starved = true;
+            starved_.push_back(fd);
+        }
+        return;
+    }
+    PrepRecv_(fd);
+}
+
+void UringPoller::Reset_(int fd) {
+    FdState& st = State_(fd);
+    st.starved = false;
+    if(st.armed) PrepCancel_(OP_POLL, fd, st.pollGen);
+    if(st.multishot) PrepCancel_(st.kind == LISTEN_FD ? OP_ACCEPT : OP_RECV, fd, st.gen);
+    if(st.heldNum) {
+        while(st.heldHead != NO_BUF) {
+            uint16_t bid = st.heldHead;
+            st.heldHead = bufNext_[bid];
+            RecycleBuf_(bid);
+        }
+        PublishBufs_();
+    }
+    if(st.kind == LISTEN_FD) {
+        for(auto it = accepted_.begin(); it != accepted_.end(); ) {
+            if(it->first == fd) {
+                close(it->second);
+                it = accepted_.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+    st = FdState{st.gen + 1, st.pollGen + 1, 0, 0, POLL_FD, false, false, false, false, false, false, false, 0,
+                 NO_BUF, NO_BUF, 0};
+}
+
+void UringPoller::RecycleBuf_(uint16_t bid) {
+    assert(bid < BUF_NUM && bufHeld_ > 0);
+    /* 内核头文件的 __DECLARE_FLEX_ARRAY 在 C++ 中多出一个空结构体成员，bufs 的偏移不为 0，直接按数组寻址 */
+    io_uring_buf& buf = reinterpret_cast<io_uring_buf*>(bufRing_)[bufTail_ & (BUF_NUM - 1)];
+    buf.addr = reinterpret_cast<uint64_t>(bufBase_ + static_cast<size_t>(bid) * BUF_SIZE);
+    buf.len = BUF_SIZE;
+    buf.bid = bid;
+    bufTail_++;
+    bufHeld_--;
+}
+
+void UringPoller::PublishBufs_() {
+    __atomic_store_n(&bufRing_->tail, bufTail_, __ATOMIC_RELEASE);
+    /* 归还的缓冲区先给因缓冲区耗尽而停止接收的连接 */
+    while(!starved_.empty() && bufHeld_ < BUF_NUM) {
+        int fd = starved_.back();
+        starved_.pop_back();
+        if(fds_[fd].starved) {
+            fds_[fd].starved = false;
+            TryRecv_(fd);
+        }
+    }
+}
+
+io_uring_sqe* UringPoller::GetSqe_(Op op, int fd, uint32_t gen) {
+    while(Pending_() >= sqEntries_) {
+        /* 提交队列已满，先把积压的请求交给内核；完成队列溢出时先收割 */
+        if(Enter_(Pending_(), 0, 0, nullptr) < 0 && errno == EBUSY) Reap_();
+    }
+    unsigned idx = sqeTail_ & sqMask_;
+    io_uring_sqe* sqe = &sqes_[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->fd = fd;
+    sqe->user_data = UserData_(op, fd, gen);
+    sqArray_[idx] = idx;
+    return sqe;
+}
+
+void UringPoller::PrepPoll_(int fd) {
+    FdState& st = fds_[fd];
+    io_uring_sqe* sqe = GetSqe_(OP_POLL, fd, st.pollGen);
+    sqe->opcode = IORING_OP_POLL_ADD;
+    /* 单次 POLL_ADD 武装时会先检查就绪状态，语义等同于 EPOLLONESHOT；连接的读就绪由 RECV 负责 */
+    uint32_t events = st.events & ~(EPOLLONESHOT | EPOLLET);
+    if(st.kind == CONN_FD) events &= ~EPOLLIN;
+    sqe->poll32_events = events;
+    st.armed = true;
+    __atomic_store_n(sqTail_, ++sqeTail_, __ATOMIC_RELEASE);
+}
+
+void UringPoller::PrepAccept_(int fd) {
+    FdState& st = fds_[fd];
+    io_uring_sqe* sqe = GetSqe_(OP_ACCEPT, fd, st.gen);
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_NONBLOCK;
+    st.multishot = true;
+    __atomic_store_n(sqTail_, ++sqeTail_, __ATOMIC_RELEASE);
+}
+
+void UringPoller::PrepRecv_(int fd) {
+    FdState& st = fds_[fd];
+    io_uring_sqe* sqe = GetSqe_(OP_RECV, fd, st.gen);
+    sqe->opcode = IORING_OP_RECV;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUF_GROUP;
+    st.multishot = true;
+    __atomic_store_n(sqTail_, ++sqeTail_, __ATOMIC_RELEASE);
+}
+
+void UringPoller::PrepCancel_(Op op, int fd, uint32_t gen) {
+    io_uring_sqe* sqe = GetSqe_(OP_IGNORE, -1, 0);
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->addr = UserData_(op, fd, gen);
+    __atomic_store_n(sqTail_, ++sqeTail_, __ATOMIC_RELEASE);
+}
+
+UringPoller::FdState& UringPoller::State_(int fd) {
+    if(static_cast<size_t>(fd) >= fds_.size()) {
+        fds_.resize(fd + 1, FdState{0, 0, 0, 0, POLL_FD, false, false, false, false, false, false, false, 0,
+                                    NO_BUF, NO_BUF, 0});
+    }
+    return fds_[fd];
+}
+
+int UringPoller::Enter_(unsigned toSubmit, unsigned minComplete, unsigned flags, __kernel_timespec* ts) {
+    io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.ts = reinterpret_cast<uint64_t>(ts);
+    /* 提交数必须与队列中的请求数一致：内核少交时不会等待完成事件 */
+    return syscall(__NR_io_uring_enter, ringFd_, toSubmit, minComplete,
+                   flags | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+}
+
+void UringPoller::FlushIfForeign_() {
+    if(loopThread_.load() == std::this_thread::get_id()) return;
+    std::lock_guard<std::mutex> locker(mtx_);
+    if(!ready_.empty()) {
+        /* 事件循环可能正阻塞在 Wait 中，NOP 的完成事件把它唤醒来上报 ready_ */
+        io_uring_sqe* sqe = GetSqe_(OP_IGNORE, -1, 0);
+        sqe->opcode = IORING_OP_NOP;
+        __atomic_store_n(sqTail_, ++sqeTail_, __ATOMIC_RELEASE);
+    }
+    unsigned toSubmit = Pending_();
+    if(toSubmit) Enter_(toSubmit, 0, 0, nullptr);
+}
\ No newline at end of file
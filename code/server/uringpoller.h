@@ -0,0 +1,183 @@
+/*
+ * @Date         : 2026-10-18
+ * @copyleft Apache 2.0
+ */
+#ifndef URINGPOLLER_H
+#define URINGPOLLER_H
+
+#include <linux/io_uring.h>
+#include <sys/syscall.h> // io_uring_setup/io_uring_enter
+#include <sys/mman.h>    // mmap
+#include <unistd.h>      // close()
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <deque>
+#include "poller.h"
+
+/*
+ * UringPoller: 基于 io_uring 的事件后端，与 Epoller 扮演相同角色。
+ * 监听 socket 挂一个多发 ACCEPT，已连接 socket 挂一个多发 RECV，数据由内核直接收进预先注册的缓冲区环，
+ * 连接的读就绪、accept 与 recv 都不再需要各自的系统调用；EPOLLONESHOT 的读事件重新武装只改状态，不提交请求。
+ * 写就绪与其他 fd（inotify 等）仍用 POLL_ADD。所有请求都只填写在提交队列中，由下一次 Wait 的一次 io_uring_enter 批量提交。
+ * 非 Reactor 线程（线程池工作线程）调用时立即提交，有新的就绪事件时附带一个 NOP 唤醒事件循环。
+ */
+class UringPoller : public Poller {
+public:
+    explicit UringPoller(unsigned entries = 4096, int maxEvent = 1024);
+
+    ~UringPoller() override;
+
+    /**
+     * io_uring 是否初始化成功（内核不支持时返回 false，调用方回退到 Epoller）
+     */
+    bool IsValid() const { return ringFd_ >= 0; }
+
+    bool AddFd(int fd, uint32_t events) override;
+
+    bool ModFd(int fd, uint32_t events) override;
+
+    bool DelFd(int fd) override;
+
+    bool AddListen(int fd, uint32_t events) override;
+
+    bool AddConn(int fd, uint32_t events) override;
+
+    int Accept(int listenFd, sockaddr_in* addr) override;
+
+    bool OwnsRecv() const override { return bufRing_ != nullptr; }
+
+    ssize_t Recv(int fd, const std::function<void(const char*, size_t)>& sink, int* saveErrno) override;
+
+    int Wait(int timeoutMs = -1) override;
+
+    int GetEventFd(size_t i) const override;
+
+    uint32_t GetEvents(size_t i) const override;
+
+    static const unsigned BUF_NUM = 1024;   /* 接收缓冲区个数（2 的幂），由所有连接共享 */
+    static const unsigned BUF_SIZE = 4096;
+    /* 单个连接最多占用的缓冲区数。多发 recv 会不停地把数据收走，
+       连接积压的数据达到上限时取消它的 recv，读出后再重新提交，TCP 流控因此仍然有效 */
+    static const unsigned MAX_HELD = 16;
+
+private:
+    enum Kind : uint8_t {
+        POLL_FD,     /* POLL_ADD 报告就绪 */
+        LISTEN_FD,   /* 多发 ACCEPT */
+        CONN_FD,     /* 多发 RECV 接收数据，写就绪用 POLL_ADD */
+    };
+    enum Op : uint8_t { OP_POLL, OP_ACCEPT, OP_RECV, OP_IGNORE };
+
+    struct FdState {
+        uint32_t gen;        // 每次注册递增，丢弃过期的 ACCEPT/RECV 完成事件
+        uint32_t pollGen;    // 每次 POLL_ADD 递增，丢弃被替换的 POLL_ADD 的完成事件
+        uint32_t events;     // 注册的事件掩码
+        uint32_t revents;    // 待上报的事件
+        Kind kind;
+        bool armed;          // 是否有未完成的 POLL_ADD
+        bool multishot;      // 是否有未结束的多发 ACCEPT/RECV
+        bool cancelling;     // 已为积压过多的连接提交取消
+        bool starved;        // 缓冲区耗尽，等待有空闲缓冲区后重新提交 RECV
+        bool inArmed;        // CONN_FD 是否等待读事件，EPOLLONESHOT 触发后清除，ModFd 重新设置
+        bool ready;          // 是否已在 ready_ 中等待上报
+        bool eof;            // 对端已关闭写
+        int err;             // 接收出错的 errno
+        uint16_t heldHead;   // 已收到未读出的缓冲区链表（bufNext_ 相连）
+        uint16_t heldTail;
+        uint16_t heldNum;
+    };
+
+    /* 以下 *_ 私有函数要求调用方持有 mtx_ */
+    io_uring_sqe* GetSqe_(Op op, int fd, uint32_t gen);
+    void PrepPoll_(int fd);
+    void PrepAccept_(int fd);
+    void PrepRecv_(int fd);
+    void PrepCancel_(Op op, int fd, uint32_t gen);
+    /**
+     * 连接没有在途的 RECV 时重新提交；已关闭、出错、积压已满时不提交，缓冲区耗尽时排入 starved_
+     */
+    void TryRecv_(int fd);
+    /**
+     * 取消 fd 上在途的请求并归还它持有的缓冲区
+     */
+    void Reset_(int fd);
+    /**
+     * 处理完成队列中的全部事件，就绪的 fd 排入 ready_
+     */
+    void Reap_();
+    void OnRecv_(int fd, const io_uring_cqe& cqe);
+    void OnAccept_(int fd, const io_uring_cqe& cqe);
+    void MarkReady_(int fd, uint32_t revents);
+    /**
+     * 连接有数据、已关闭或出错且在等待读事件时上报 EPOLLIN
+     */
+    void MarkIn_(int fd);
+    void RecycleBuf_(uint16_t bid);
+    void PublishBufs_();
+    FdState& State_(int fd);
+    bool SetupBufRing_();
+
+    /**
+     * 已填写未提交的请求数
+     */
+    unsigned Pending_() const { return sqeTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE); }
+    /**
+     * 提交 toSubmit 个排队的请求，可选地等待完成
+     */
+    int Enter_(unsigned toSubmit, unsigned minComplete, unsigned flags, __kernel_timespec* ts);
+    /**
+     * 非事件循环线程调用时立即提交积压的请求，有待上报的事件时唤醒事件循环
+     */
+    void FlushIfForeign_();
+
+    static uint64_t UserData_(Op op, int fd, uint32_t gen) {
+        return (static_cast<uint64_t>(op) << 56) | (static_cast<uint64_t>(gen & GEN_MASK) << 32)
+               | static_cast<uint32_t>(fd);
+    }
+    static const uint32_t GEN_MASK = 0xffffff;
+    static const uint16_t NO_BUF = 0xffff;
+    static const uint16_t BUF_GROUP = 0;
+
+    int ringFd_;
+    void* ringPtr_;
+    size_t ringSize_;
+    io_uring_sqe* sqes_;
+    size_t sqesSize_;
+
+    unsigned* sqHead_;
+    unsigned* sqTail_;
+    unsigned* sqArray_;
+    unsigned sqMask_;
+    unsigned sqEntries_;
+    unsigned sqeTail_;
+
+    unsigned* cqHead_;
+    unsigned* cqTail_;
+    unsigned cqMask_;
+    io_uring_cqe* cqes_;
+
+    io_uring_buf_ring* bufRing_;   /* 提供给内核的缓冲区环，为空时连接退回 POLL_ADD + recv */
+    char* bufBase_;
+    uint16_t bufTail_;
+    unsigned bufHeld_;             /* 不在环中（被连接持有）的缓冲区数 */
+    uint16_t bufNext_[BUF_NUM];
+    uint32_t bufLen_[BUF_NUM];
+    bool recvMultishot_;           /* 内核不支持多发 recv/accept 时清除，退回 POLL_ADD */
+    bool acceptMultishot_;
+
+    std::mutex mtx_;
+    std::atomic<std::thread::id> loopThread_;
+    std::vector<FdState> fds_;
+    std::vector<int> rearm_;       /* 下一次 Wait 时重新提交的 POLL_ADD / ACCEPT */
+    std::vector<int> starved_;
+    std::vector<int> ready_;
+    std::deque<std::pair<int, int>> accepted_;   /* (监听 fd, 新连接 fd) */
+    std::vector<struct epoll_event> events_;
+};
+
+#endif //URINGPOLLER_H
\ No newline at end of file
@@ -3,19 +3,61 @@
 WebServer::WebServer(int port, int trigMode, int timeoutMS, bool OptLinger, 
         int sqlPort, const char* sqlUser, const  char* sqlPwd, 
         const char* dbName, int connPoolNum, int threadNum,
-        bool openLog, int logLevel, int logQueSize):
-        port_(port), openLinger_(OptLinger), timeoutMS_(timeoutMS), isClose_(false),
-        timer_(new HeapTimer()), threadpool_(new ThreadPool(threadNum)), epoller_(new Epoller()) {
+        bool openLog, int logLevel, int logQueSize, int reactorNum,
+        bool ioUring, bool runToCompletion, int compressThreadNum, int compressMin,
+        int taskQueueSize, int dbThreadNum, int dbQueueSize):
+        port_(port), openLinger_(OptLinger), timeoutMS_(timeoutMS), isClose_(false) {
     srcDir_ = getcwd(nullptr, 256);
     assert(srcDir_);
     strncat(srcDir_, "/resources/", 12);
     HttpConn::userCount = 0;
     HttpConn::srcDir = srcDir_;
+    /* 文件缓存的大文件条目各持有一个 fd，从 RLIMIT_NOFILE 中为它预留配额，其余留给连接 */
+    rlimit rl;
+    rlim_t nofile = getrlimit(RLIMIT_NOFILE, &rl) == 0 ? rl.rlim_cur : static_cast<rlim_t>(MAX_FD);
+    size_t cacheFds = std::min<rlim_t>(FileCache::DEFAULT_MAX_FDS, nofile / 8);
+    FileCache::Instance()->Init(srcDir_, FileCache::DEFAULT_BUDGET, FileCache::DEFAULT_MAX_ENTRIES, cacheFds);
+    maxFd_ = static_cast<int>(std::min<rlim_t>(MAX_FD, nofile - cacheFds));
+    bool inlineIO = reactorNum > 0 || runToCompletion;
+    if(!inlineIO) {
+        /* 队列满时反压 Reactor，读事件留在内核里等待 */
+        lanes_[Reactor::STATIC_LANE].reset(new ThreadPool(threadNum, taskQueueSize));
+    }
+    /* 数据库道满时拒绝，由 Reactor 回复 503，提交的线程不会被慢查询拖住 */
+    lanes_[Reactor::DB_LANE].reset(new ThreadPool(dbThreadNum, dbQueueSize, ThreadPool::REJECT));
+    if(compressThreadNum > 0 && compressMin > 0) {
+        lanes_[Reactor::COMPRESS_LANE].reset(new ThreadPool(compressThreadNum));
+        HttpResponse::compressMin = compressMin;
+        /* 静态文件的预压缩变体也在压缩道中生成 */
+        FileCache::Instance()->SetCompressLane(lanes_[Reactor::COMPRESS_LANE].get());
+    }
+    /* 对端提前关闭时 sendfile/writev 会触发 SIGPIPE，改为由返回值 EPIPE 处理 */
+    signal(SIGPIPE, SIG_IGN);
     SqlConnPool::Instance()->Init("localhost", sqlPort, sqlUser, sqlPwd, dbName, connPoolNum);
 
+    users_.reset(new HttpConn[maxFd_]);
+
     InitEventMode_(trigMode);
+    Reactor::Lanes lanes;
+    for(int i = 0; i < Reactor::LANE_NUM; i++) lanes[i] = lanes_[i].get();
+    if(reactorNum > 0) {
+        /* 多 Reactor：每个 Reactor 在自己的线程内完成读写，线程池只处理数据库校验与压缩 */
+        for(int i = 0; i < reactorNum; i++) {
+            reactors_.emplace_back(new Reactor(users_.get(), maxFd_, timeoutMS_, listenEvent_, connEvent_,
+                                               lanes, true, ioUring));
+        }
+    }
+    else {
+        reactors_.emplace_back(new Reactor(users_.get(), maxFd_, timeoutMS_, listenEvent_, connEvent_,
+                                           lanes, runToCompletion, ioUring));
+    }
     if(!InitSocket_()) isClose_ = true;
 
+    watcher_.reset(new FileWatcher());
+    bool watched = watcher_->Init(srcDir_) && reactors_[0]->AddWatcher(watcher_.get());
+    FileCache::Instance()->SetWatched(watched);
+    if(!watched) watcher_.reset();
+
     if(openLog) {
         Log::Instance()->init(logLevel, "./log", ".log", logQueSize);
         if(isClose_) {LOG_ERROR("======== Server Init Error ========");}
@@ -23,16 +65,34 @@ WebServer::WebServer(int port, int trigMode, int timeoutMS, bool OptLinger,
             LOG_INFO("======== Server Init ========");
             LOG_INFO("Port:%d, OpenLinger: %s", port_, OptLinger ? "true" : "false");
             LOG_INFO("Listen Mode: %s, Openconn Mode: %s", (listenEvent_ & EPOLLET ? "ET" : "LT"), (connEvent_ & EPOLLET ? "ET" : "LT"));
+            LOG_INFO("Reactor num: %d, Mode: %s, Poller: %s", (int)reactors_.size(),
+                     reactorNum > 0 ? "multi-reactor" : (runToCompletion ? "run-to-completion" : "reactor + threadpool"), reactors_[0]->PollerName());
+            LOG_INFO("Conn slots: %d, HttpScan: %s", maxFd_, HttpScan::Isa());
             LOG_INFO("Logsys level: %d", logLevel);
-            LOG_INFO("srcDir: %s", HttpConn::srcDir);
-            LOG_INFO("SqlConnPool num: %d, ThreadPool num: %d", connPoolNum, threadNum);
+            LOG_INFO("srcDir: %s, FileCache invalidation: %s, fds: %zu", HttpConn::srcDir,
+                     watcher_ ? "inotify" : "periodic stat", cacheFds);
+            LOG_INFO("SqlConnPool num: %d", connPoolNum);
+            LOG_INFO("Lanes static: %d threads, queue %d; db: %d threads, queue %d",
+                     inlineIO ? 0 : threadNum, inlineIO ? 0 : taskQueueSize, dbThreadNum, dbQueueSize);
+            LOG_INFO("Compress pool num: %d, min size: %d", lanes_[Reactor::COMPRESS_LANE] ? compressThreadNum : 0,
+                     lanes_[Reactor::COMPRESS_LANE] ? compressMin : 0);
         }
     }
 }
 
 WebServer::~WebServer() {
-    close(listenFd_);
     isClose_ = true;
+    /* 先关闭各道线程池并等待排队的任务执行完，任务引用的 Reactor、连接槽位与数据库连接池此时都还有效 */
+    FileCache::Instance()->SetCompressLane(nullptr);
+    for(std::unique_ptr<ThreadPool>& lane : lanes_) {
+        lane.reset();
+    }
+    reactors_.clear();
+    FileCache::Stats stats = FileCache::Instance()->GetStats();
+    LOG_INFO("FileCache hits: %llu, misses: %llu, full-response hits: %llu, bytes served: %llu",
+             (unsigned long long)stats.hits, (unsigned long long)stats.misses,
+             (unsigned long long)stats.responseHits, (unsigned long long)stats.bytesServed);
+    users_.reset();
     free(srcDir_);
     SqlConnPool::Instance()->ClosePool();
 }
@@ -61,204 +121,95 @@ void WebServer::InitEventMode_(int trigMode) {
 }
 
 void WebServer::Start() {
-    int timeMS = -1;
-    if(!isClose_) LOG_INFO("======== Server Start ========");
-    while(!isClose_) {
-        if(timeoutMS_ > 0) {
-            timeMS = timer_->GetNextTick();
-        }
-        int eventCnt = epoller_->Wait(timeMS);
-        for(int i = 0; i < eventCnt; i++) {
-            int fd = epoller_->GetEventFd(i);
-            uint32_t events = epoller_->GetEvents(i);
-            if(fd == listenFd_) {
-                DealListen_();
-            }
-            else if(events & (EPOLLRDHUP | EPOLLHUP | EPOLLIN)) {
-                assert(users_.contains(fd));
-                CloseConn_(&users_[fd]);
-            }
-            else if(events & EPOLLIN) {
-                assert(users_.contains(fd));
-                DealRead_(&users_[fd]);
-            }
-            else if(events & EPOLLOUT) {
-                assert(users_.contains(fd));
-                DealWrite_(&users_[fd]);
-            }
-            else {
-                LOG_ERROR("Unexpected Event");
-            }
-        }
+    if(isClose_) return;
+    LOG_INFO("======== Server Start ========");
+    std::vector<std::thread> threads;
+    for(size_t i = 1; i < reactors_.size(); i++) {
+        threads.emplace_back(&Reactor::Loop, reactors_[i].get());
+    }
+    reactors_[0]->Loop();
+    for(auto& t : threads) {
+        t.join();
     }
 }
 
 bool WebServer::InitSocket_() {
-    int ret;
-    sockaddr_in addr;
     if(port_ > 65535 || port_ < 1024) {
         LOG_ERROR("Unvalid Port: %d", port_);
         return false;
     }
+    bool reusePort = reactors_.size() > 1;
+    for(auto& reactor : reactors_) {
+        int listenFd = CreateListenFd_(reusePort);
+        if(listenFd < 0) {
+            return false;
+        }
+        if(!reactor->AddListenFd(listenFd)) {
+            close(listenFd);
+            LOG_ERROR("Add Fd Failed");
+            return false;
+        }
+        Reactor::SetFdNonblock(listenFd);
+    }
+    LOG_INFO("Init Socket Success  Port:%d", port_);
+    return true;
+}
+
+int WebServer::CreateListenFd_(bool reusePort) {
+    int ret;
+    sockaddr_in addr;
     addr.sin_family = AF_INET;
     addr.sin_addr.s_addr = htonl(INADDR_ANY);
-    addr.sin_port = htonl(port_);
+    addr.sin_port = htons(port_);
     linger optLinger = { 0 };
     if(openLinger_) {
         optLinger.l_onoff = 1;
         optLinger.l_linger = 1;
     }
 
-    listenFd_ = socket(AF_INET, SOCK_STREAM, 0);
-    if(listenFd_ < 0) {
+    int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if(listenFd < 0) {
         LOG_ERROR("Listen Socket Init Failed");
-        return false;
+        return -1;
     }
 
-    ret = setsockopt(listenFd_, SOL_SOCKET, SO_LINGER, &optLinger, sizeof(optLinger));
+    ret = setsockopt(listenFd, SOL_SOCKET, SO_LINGER, &optLinger, sizeof(optLinger));
     if(ret < 0) {
-        close(listenFd_);
+        close(listenFd);
         LOG_ERROR("Listen Socket Options Set Failed");
-        return false;
+        return -1;
     }
 
     int optival = 1;
-    ret = setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, (const void*)&optival, sizeof(int));
+    ret = setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, (const void*)&optival, sizeof(int));
     if(ret < 0) {
-        close(listenFd_);
+        close(listenFd);
         LOG_ERROR("Listen Socket Reuse Addr Set Failed");
-        return false;
-    }
-
-    ret = bind(listenFd_, (sockaddr*)&addr, sizeof(addr));
-    if(ret < 0) {
-        close(listenFd_);
-        LOG_ERROR("Listen Socket Bind Failed");
-        return false;
-    }
-
-    ret = listen(listenFd_, 6);
-    if(ret < 0) {
-        close(listenFd_);
-        LOG_ERROR("Add Listen Failed");
-        return false;
-    }
-    ret = epoller_->AddFd(listenFd_, listenEvent_ | EPOLLIN);
-    if(ret == 0) {
-        close(listenFd_);
-        LOG_ERROR("Add Fd Failed");
-        return false;
+        return -1;
     }
-    SetFdNonblock(listenFd_);
-    LOG_INFO("Init Socket Success  Port:%d", port_);
-    return true;
-}
-
 
-void WebServer::AddClient_(int fd, sockaddr_in addr) {
-    assert(fd > 0);
-    users_[fd].init(fd, addr);
-    if(timeoutMS_ > 0) {
-        timer_->add(fd, timeoutMS_, std::bind(&WebServer::CloseConn_, this, &users_[fd]));
-    }
-    epoller_->AddFd(fd, connEvent_ | EPOLLIN);
-    SetFdNonblock(fd);
-    LOG_INFO("New Client[%d] in", users_[fd].GetFd());
-}
-
-void WebServer::DealListen_() {
-    sockaddr_in addr;
-    socklen_t len = sizeof(addr);
-    do {
-        int fd = accept(listenFd_, (sockaddr*)&addr, &len);
-        if(fd <= 0) return;
-        else if(HttpConn::userCount >= MAX_FD) {
-            SendError_(fd, "Server busy");
-            LOG_WARN("No Spare Client");
-            return;
+    if(reusePort) {
+        /* 内核按四元组哈希把新连接分给各个监听 socket，accept 无需跨线程 */
+        ret = setsockopt(listenFd, SOL_SOCKET, SO_REUSEPORT, (const void*)&optival, sizeof(int));
+        if(ret < 0) {
+            close(listenFd);
+            LOG_ERROR("Listen Socket Reuse Port Set Failed");
+            return -1;
         }
-        AddClient_(fd, addr);
-    }while(listenEvent_ & EPOLLET);
-}
-
-void WebServer::DealRead_(HttpConn* client) {
-    assert(client);
-    ExtentTime_(client);
-    threadpool_->AddTask(std::bind(&WebServer::OnRead_, this, client));
-}
-
-void WebServer::DealWrite_(HttpConn* client) {
-    assert(client);
-    ExtentTime_(client);
-    threadpool_->AddTask(std::bind(&WebServer::OnWrite_, this, client));
-}
-
-void WebServer::ExtentTime_(HttpConn* client) {
-    assert(client);
-    if(timeoutMS_ > 0) {
-        timer_->adjust(client->GetFd(), timeoutMS_);
     }
-}
 
-void WebServer::CloseConn_(HttpConn* client) {
-    assert(client);
-    LOG_INFO("Client[%d] quit!", client->GetFd());
-    timer_->doWork(client->GetFd());
-    client->Close();
-    epoller_->DelFd(client->GetFd());
-}
-
-void WebServer::SendError_(int fd, const char* info) {
-    assert(fd > 0);
-    int ret = send(fd, info, strlen(info), 0);
+    ret = bind(listenFd, (sockaddr*)&addr, sizeof(addr));
     if(ret < 0) {
-        LOG_WARN("Send Error to Client[%d] Failed", fd);
-    }
-    close(fd);
-}
-
-void WebServer::OnRead_(HttpConn* client) {
-    assert(client);
-    int ret = -1;
-    int readErrno = 0;
-    ret = client->read(&readErrno);
-    if(ret <= 0 && readErrno != EAGAIN) {
-        CloseConn_(client);
-        return;
-    }
-    OnProcess(client);
-}
-
-void WebServer::OnWrite_(HttpConn* client) {
-    assert(client);
-    int ret = -1;
-    int writeErrno = 0;
-    ret = client->write(&writeErrno);
-    if(client->ToWriteBytes() == 0) {
-        if(client->IsKeepAlive()) {
-            OnProcess(client);
-            return;
-        }
-    }
-    else if(ret < 0) {
-        if(writeErrno == EAGAIN) {
-            epoller_->ModFd(client->GetFd(), connEvent_ | EPOLLOUT);
-            return;
-        }
+        close(listenFd);
+        LOG_ERROR("Listen Socket Bind Failed");
+        return -1;
     }
-    CloseConn_(client);
-}
 
-void WebServer::OnProcess(HttpConn* client) {
-    assert(client);
-    if(client->process()) {
-        epoller_->ModFd(client->GetFd(), connEvent_ | EPOLLOUT);
-    } else {
-        epoller_->ModFd(client->GetFd(), connEvent_ | EPOLLIN);
+    ret = listen(listenFd, 6);
+    if(ret < 0) {
+        close(listenFd);
+        LOG_ERROR("Add Listen Failed");
+        return -1;
     }
-}
-
-int WebServer::SetFdNonblock(int fd) {
-    assert(fd > 0);
-    return fcntl(fd, F_SETFL, fcntl(fd, F_GETFD, 0) | O_NONBLOCK);
+    return listenFd;
 }
\ No newline at end of file
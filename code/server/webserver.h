@@ -7,15 +7,20 @@
 #define WEBSERVER_H
 
 #include <unordered_map>
+#include <sys/resource.h> // getrlimit()
+#include <vector>
+#include <thread>
 #include <fcntl.h>       // fcntl()
 #include <unistd.h>      // close()
 #include <assert.h>
 #include <errno.h>
+#include <signal.h>      // signal()
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
 #include "epoller.h"
+#include "reactor.h"
 #include "../log/log.h"
 #include "../timer/heaptimer.h"
 #include "../pool/sqlconnpool.h"
@@ -29,82 +34,51 @@ public:
         int port, int trigMode, int timeoutMS, bool OptLinger, 
         int sqlPort, const char* sqlUser, const  char* sqlPwd, 
         const char* dbName, int connPoolNum, int threadNum,
-        bool openLog, int logLevel, int logQueSize);
+        bool openLog, int logLevel, int logQueSize, int reactorNum = 0,
+        bool ioUring = false, bool runToCompletion = false,
+        int compressThreadNum = 1, int compressMin = 1024,
+        int taskQueueSize = 4096, int dbThreadNum = 4, int dbQueueSize = 64);
 
     ~WebServer();
     void Start();
 
 private:
     /**
-     * 初始化监听 socket、绑定端口并开始监听
+     * 为每个 Reactor 初始化监听 socket、绑定端口并开始监听
      */
     bool InitSocket_(); 
     /**
-     * 根据触发模式设置事件（LT/ET）
-     */
-    void InitEventMode_(int trigMode);
-    /**
-     * 新客户端接入时添加到管理结构并注册定时器
-     */
-    void AddClient_(int fd, sockaddr_in addr);
-  
-    /**
-     * 处理监听套接字上的可读事件（accept 新连接）
-     */
-    void DealListen_();
-    /**
-     * 处理写事件：将待写数据发送到客户端
-     */
-    void DealWrite_(HttpConn* client);
-    /**
-     * 处理读事件：读取并解析请求，交给线程池处理
-     */
-    void DealRead_(HttpConn* client);
-
-    /**
-     * 向 fd 发送错误信息并关闭连接
+     * 创建一个监听 socket
+     * @param reusePort 是否设置 SO_REUSEPORT（多 Reactor 模式下每个 Reactor 一个监听 socket）
+     * @return 监听 fd，失败返回 -1
      */
-    void SendError_(int fd, const char*info);
+    int CreateListenFd_(bool reusePort);
     /**
-     * 扩展客户端定时器（重置超时时间）
-     */
-    void ExtentTime_(HttpConn* client);
-    /**
-     * 关闭客户端连接并清理资源
-     */
-    void CloseConn_(HttpConn* client);
-
-    /**
-     * 读事件的高层回调：从 socket 读取数据并准备处理
-     */
-    void OnRead_(HttpConn* client);
-    /**
-     * 写事件的高层回调：处理写完成或继续写入
-     */
-    void OnWrite_(HttpConn* client);
-    /**
-     * 处理完成回调：执行请求处理逻辑
+     * 根据触发模式设置事件（LT/ET）
      */
-    void OnProcess(HttpConn* client);
+    void InitEventMode_(int trigMode);
 
     static const int MAX_FD = 65536;
 
-    static int SetFdNonblock(int fd);
-
     int port_;
     bool openLinger_;
     int timeoutMS_;  /* 毫秒MS */
     bool isClose_;
-    int listenFd_;
     char* srcDir_;
     
     uint32_t listenEvent_;
     uint32_t connEvent_;
    
-    std::unique_ptr<HeapTimer> timer_;
-    std::unique_ptr<ThreadPool> threadpool_;
-    std::unique_ptr<Epoller> epoller_;
-    std::unordered_map<int, HttpConn> users_;
+    int maxFd_;  /* 连接槽位数，取 RLIMIT_NOFILE 减去文件缓存的 fd 配额与 MAX_FD 的较小值 */
+    /* 按 fd 下标的连接槽位表，启动时一次性分配，建立连接时不再分配内存 */
+    std::unique_ptr<HttpConn[]> users_;
+    /* 按 Reactor::Lane 分道的线程池：STATIC 只在 reactor + 线程池模式下创建，
+       COMPRESS 的每个线程复用自己的 zlib 状态，关闭在线压缩时为空 */
+    std::unique_ptr<ThreadPool> lanes_[Reactor::LANE_NUM];
+    /* 资源目录的 inotify 监视器，由 reactors_[0] 处理其事件 */
+    std::unique_ptr<FileWatcher> watcher_;
+    /* reactors_[0] 运行在调用 Start 的线程上，其余各自一个线程 */
+    std::vector<std::unique_ptr<Reactor>> reactors_;
 };
 
 
@@ -0,0 +1,44 @@
+#include "coarseclock.h"
+
+std::atomic<int64_t> CoarseClock::nowMs_{0};
+std::atomic<int64_t> CoarseClock::nowUs_{0};
+
+void CoarseClock::Update() {
+    struct timespec mono, real;
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    clock_gettime(CLOCK_REALTIME, &real);
+    /* 多个 Reactor 并发更新，两个值都只允许前进，避免较早的读数覆盖较新的。
+       墙上时间被向后调整时缓存值停住，直到系统时钟追上为止 */
+    StoreMax_(nowMs_, static_cast<int64_t>(mono.tv_sec) * 1000 + mono.tv_nsec / 1000000);
+    StoreMax_(nowUs_, static_cast<int64_t>(real.tv_sec) * 1000000 + real.tv_nsec / 1000);
+}
+
+void CoarseClock::StoreMax_(std::atomic<int64_t>& value, int64_t now) {
+    int64_t prev = value.load(std::memory_order_relaxed);
+    while(prev < now && !value.compare_exchange_weak(prev, now, std::memory_order_relaxed)) {}
+}
+
+std::string_view CoarseClock::HttpDate() {
+    static thread_local time_t cachedSec = -1;
+    static thread_local char date[32];
+    static thread_local size_t len = 0;
+    time_t sec = Now();
+    if(sec != cachedSec) {
+        struct tm tm;
+        gmtime_r(&sec, &tm);
+        len = strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+        cachedSec = sec;
+    }
+    return std::string_view(date, len);
+}
+
+const CoarseClock::Local& CoarseClock::LocalTime(time_t sec) {
+    static thread_local time_t cachedSec = -1;
+    static thread_local Local local;
+    if(sec != cachedSec) {
+        localtime_r(&sec, &local.tm);
+        strftime(local.stamp, sizeof(local.stamp), "%Y-%m-%d %H:%M:%S", &local.tm);
+        cachedSec = sec;
+    }
+    return local;
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+/*
+ * @Date         : 2026-10-18
+ * @copyleft Apache 2.0
+ */
+#ifndef COARSE_CLOCK_H
+#define COARSE_CLOCK_H
+
+#include <time.h>
+#include <stdint.h>
+#include <atomic>
+#include <string_view>
+
+/*
+ * CoarseClock: 进程内共享的粗粒度时钟。
+ * 各 Reactor 在每轮事件循环 Wait 返回后调用 Update 读一次系统时钟，
+ * 定时器、日志、Date 头与文件缓存都读取这里缓存的值，不再各自查询时钟；
+ * 按秒变化的格式化结果（HTTP 日期、本地时间与日志时间前缀）由各线程缓存，每秒只转换一次。
+ */
+class CoarseClock {
+public:
+    /* 本地时间及其 "YYYY-MM-DD HH:MM:SS" 形式，用于日志 */
+    struct Local {
+        struct tm tm;
+        char stamp[24];
+    };
+
+    /**
+     * 读取系统时钟并更新缓存值，由事件循环每轮调用一次
+     */
+    static void Update();
+
+    /**
+     * 单调递增的毫秒数，用于定时器与缓存校验间隔
+     */
+    static int64_t NowMs() {
+        int64_t ms = nowMs_.load(std::memory_order_relaxed);
+        if(ms == 0) {
+            Update();
+            ms = nowMs_.load(std::memory_order_relaxed);
+        }
+        return ms;
+    }
+
+    /**
+     * 墙上时间（微秒），不会回退
+     */
+    static int64_t NowUs() {
+        int64_t us = nowUs_.load(std::memory_order_relaxed);
+        if(us == 0) {
+            Update();
+            us = nowUs_.load(std::memory_order_relaxed);
+        }
+        return us;
+    }
+
+    /**
+     * 墙上时间（秒）
+     */
+    static time_t Now() { return static_cast<time_t>(NowUs() / 1000000); }
+
+    /**
+     * 当前时间的 IMF-fixdate 形式（如 "Sun, 06 Nov 1994 08:49:37 GMT"），指向本线程的缓存
+     */
+    static std::string_view HttpDate();
+
+    /**
+     * 第 sec 秒的本地时间，指向本线程的缓存，sec 与上次相同时不重新转换
+     */
+    static const Local& LocalTime(time_t sec);
+
+private:
+    /* value 小于 now 时更新为 now */
+    static void StoreMax_(std::atomic<int64_t>& value, int64_t now);
+
+    static std::atomic<int64_t> nowMs_;
+    static std::atomic<int64_t> nowUs_;
+};
+
+#endif //COARSE_CLOCK_H
\ No newline at end of file
@@ -35,17 +35,17 @@ bool HeapTimer::siftdown_(size_t index, size_t n) {
 
 void HeapTimer::siftup_(size_t index) {
     size_t i = index;
-    size_t j = (i - 1) / 2;
-    while(j >= 0) {
+    while(i > 0) {
+        size_t j = (i - 1) / 2;
         if(heap_[j] < heap_[i]) break;
         SwapNode_(i, j);
         i = j;
-        j = (i - 1) / 2;
     }
 }
 
 void HeapTimer::adjust(int id, int newExpires) {
-    heap_[ref_[id]].expires = Clock::now() + MS(newExpires);
+    if(!ref_.contains(id)) return;
+    heap_[ref_[id]].expires = CoarseClock::NowMs() + newExpires;
     siftdown_(ref_[id], heap_.size());
 }
 
@@ -54,12 +54,12 @@ void HeapTimer::add(int id, int timeOut, const TimeoutCallBack& cb) {
     if(!ref_.contains(id)) {
         i = heap_.size();
         ref_[id] = i;
-        heap_.push_back({id, Clock::now() + MS(timeOut), cb});
+        heap_.push_back({id, CoarseClock::NowMs() + timeOut, cb});
         siftup_(i);
     }
     else {
         i = ref_[id];
-        heap_[i].expires = Clock::now() + MS(timeOut);
+        heap_[i].expires = CoarseClock::NowMs() + timeOut;
         heap_[i].cb = cb;
         if(!siftdown_(i, heap_.size())) {
             siftup_(i);
@@ -71,10 +71,16 @@ void HeapTimer::doWork(int id) {
     if(heap_.empty() || !ref_.contains(id)) {
         return;
     }
-    size_t i = id;
-    TimerNode node = heap_[i];
+    /* 先出堆再回调，回调中可以安全地增删定时器 */
+    TimerNode node = heap_[ref_[id]];
+    del_(ref_[id]);
     node.cb();
-    del_(i);
+}
+
+void HeapTimer::del(int id) {
+    auto it = ref_.find(id);
+    if(it == ref_.end()) return;
+    del_(it->second);
 }
 
 void HeapTimer::clear() {
@@ -86,13 +92,14 @@ void HeapTimer::tick() {
     if(heap_.empty()) {
         return;
     }
+    int64_t now = CoarseClock::NowMs();
     while(!heap_.empty()) {
         TimerNode node = heap_.front();
-        if(std::chrono::duration_cast<MS>(node.expires - Clock::now()).count() > 0) {
+        if(node.expires > now) {
             break;
         }
-        node.cb();
         pop();
+        node.cb();
     }
 }
 
@@ -102,9 +109,9 @@ void HeapTimer::pop() {
 
 int HeapTimer::GetNextTick() {
     tick();
-    size_t res = 0;
+    int res = -1;
     if(!heap_.empty()) {
-        res = std::chrono::duration_cast<MS>(heap_.front().expires - Clock::now()).count();
+        res = static_cast<int>(heap_.front().expires - CoarseClock::NowMs());
         if(res < 0) res = 0;
     }
     return res;
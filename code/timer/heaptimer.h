@@ -13,17 +13,14 @@
 #include <arpa/inet.h> 
 #include <functional> 
 #include <assert.h> 
-#include <chrono>
 #include "../log/log.h"
+#include "coarseclock.h"
 
 typedef std::function<void()> TimeoutCallBack;
-typedef std::chrono::high_resolution_clock Clock;
-typedef std::chrono::milliseconds MS;
-typedef Clock::time_point TimeStamp;
 
 struct TimerNode {
     int id;
-    TimeStamp expires;
+    int64_t expires;  /* 到期时刻，CoarseClock::NowMs() 的毫秒数 */
     TimeoutCallBack cb;
     // 比较运算符（按过期时间排序）
     bool operator<(const TimerNode& t) {
@@ -56,6 +53,11 @@ public:
      */
     void doWork(int id);
 
+    /**
+     * 删除指定 id 的定时器，不执行回调（不存在时忽略）
+     */
+    void del(int id);
+
     /**
      * 清空定时器堆
      */
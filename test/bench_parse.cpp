@@ -0,0 +1,132 @@
+/*
+ * @Date         : 2026-10-18
+ * @copyleft Apache 2.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <regex>
+#include <chrono>
+#include <algorithm>
+#include "../code/http/httprequest.h"
+
+/*
+ * 请求解析的吞吐量：同一个 7 个请求头的长连接 GET 反复追加到缓冲区并解析，单线程，
+ * 与替换前基于 std::regex、逐行拷贝 std::string 的解析流程对比
+ */
+
+static const char REQUEST[] =
+    "GET /index.html HTTP/1.1\r\n"
+    "Host: localhost:1316\r\n"
+    "User-Agent: bench/1.0\r\n"
+    "Accept: */*\r\n"
+    "Accept-Encoding: gzip\r\n"
+    "Accept-Language: en-US\r\n"
+    "Connection: keep-alive\r\n"
+    "Cache-Control: no-cache\r\n"
+    "\r\n";
+
+/* 替换前的解析流程（请求行与请求头各用一个 std::regex，请求头存入 unordered_map） */
+class LegacyRequest {
+public:
+    void Init() {
+        method_ = path_ = version_ = "";
+        state_ = REQUEST_LINE;
+        header_.clear();
+    }
+
+    bool parse(Buffer& buff) {
+        const char CRLF[] = "\r\n";
+        if(buff.ReadableBytes() <= 0) return false;
+        while(buff.ReadableBytes() && state_ != FINISH) {
+            const char* lineEnd = std::search(buff.Peek(), buff.BeginWriteConst(), CRLF, CRLF + 2);
+            std::string line(buff.Peek(), lineEnd);
+            switch(state_) {
+            case REQUEST_LINE:
+                if(!ParseRequestLine_(line)) return false;
+                break;
+            case HEADERS:
+                ParseHeader_(line);
+                if(buff.ReadableBytes() <= 2) state_ = FINISH;
+                break;
+            default:
+                break;
+            }
+            if(lineEnd == buff.BeginWrite()) break;
+            buff.RetrieveUntil(lineEnd + 2);
+        }
+        return true;
+    }
+
+    size_t HeaderNum() const { return header_.size(); }
+
+private:
+    enum PARSE_STATE { REQUEST_LINE, HEADERS, BODY, FINISH };
+
+    bool ParseRequestLine_(const std::string& line) {
+        std::regex pattern("^([^ ]*) ([^ ]*) HTTP/([^ ]*)$");
+        std::smatch subMatch;
+        if(std::regex_match(line, subMatch, pattern)) {
+            method_ = subMatch[1];
+            path_ = subMatch[2];
+            version_ = subMatch[3];
+            state_ = HEADERS;
+            return true;
+        }
+        return false;
+    }
+
+    void ParseHeader_(const std::string& line) {
+        std::regex pattern("^([^ ]*): ([^ ]*)$");
+        std::smatch subMatch;
+        if(std::regex_match(line, subMatch, pattern)) {
+            header_[subMatch[1]] = subMatch[2];
+        }
+        else {
+            state_ = BODY;
+        }
+    }
+
+    PARSE_STATE state_;
+    std::string method_, path_, version_;
+    std::unordered_map<std::string, std::string> header_;
+};
+
+static double Seconds(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+int main(int argc, char* argv[]) {
+    int legacyNum = argc > 1 ? atoi(argv[1]) : 5000;
+    int num = argc > 2 ? atoi(argv[2]) : 2000000;
+    Buffer buff;
+
+    LegacyRequest legacy;
+    auto begin = std::chrono::steady_clock::now();
+    for(int i = 0; i < legacyNum; i++) {
+        buff.Append(REQUEST, sizeof(REQUEST) - 1);
+        legacy.Init();
+        bool ok = legacy.parse(buff) && legacy.HeaderNum() == 7 && buff.ReadableBytes() == 0;
+        if(!ok) {
+            fprintf(stderr, "legacy parse failed\n");
+            return 1;
+        }
+    }
+    double legacySec = Seconds(begin);
+
+    HttpRequest request;
+    begin = std::chrono::steady_clock::now();
+    for(int i = 0; i < num; i++) {
+        buff.Append(REQUEST, sizeof(REQUEST) - 1);
+        bool ok = request.parse(buff) == HttpRequest::GET_REQUEST && buff.ReadableBytes() == 0;
+        if(!ok) {
+            fprintf(stderr, "parse failed\n");
+            return 1;
+        }
+    }
+    double sec = Seconds(begin);
+
+    printf("request %zu bytes, 7 headers, 1 thread\n", sizeof(REQUEST) - 1);
+    printf("legacy regex parser: %10.0f req/s (%d requests)\n", legacyNum / legacySec, legacyNum);
+    printf("state machine:       %10.0f req/s (%d requests)\n", num / sec, num);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,149 @@
+/*
+ * @Date         : 2026-10-18
+ * @copyleft Apache 2.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <mutex>
+#include <condition_variable>
+#include <queue>
+#include <functional>
+#include <chrono>
+#include "../code/pool/threadpool.h"
+
+/*
+ * 线程池的任务吞吐量：提交者线程各提交若干个 std::bind 任务（与 Reactor 提交的任务形式相同），
+ * 计时到全部任务执行完，并统计每个任务的内存分配次数。
+ * 与替换前的线程池（单个 std::queue<std::function> + 互斥锁 + 条件变量）对比
+ */
+
+/* 统计本线程调用全局 operator new 的次数；任务在提交者线程上构造与入队，只统计提交者 */
+static thread_local size_t allocs = 0;
+
+void* operator new(size_t size) {
+    allocs++;
+    void* p = malloc(size ? size : 1);
+    if(!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+/* 替换前的线程池 */
+class LegacyPool {
+public:
+    explicit LegacyPool(size_t threadCount) {
+        for(size_t i = 0; i < threadCount; i++) {
+            threads_.emplace_back([this] {
+                std::unique_lock<std::mutex> locker(mtx_);
+                while(true) {
+                    if(!tasks_.empty()) {
+                        auto task = std::move(tasks_.front());
+                        tasks_.pop();
+                        locker.unlock();
+                        task();
+                        locker.lock();
+                    }
+                    else if(closed_) break;
+                    else cond_.wait(locker);
+                }
+            });
+        }
+    }
+
+    ~LegacyPool() {
+        {
+            std::lock_guard<std::mutex> locker(mtx_);
+            closed_ = true;
+        }
+        cond_.notify_all();
+        for(std::thread& t : threads_) t.join();
+    }
+
+    template<class T>
+    bool AddTask(T&& task) {
+        {
+            std::lock_guard<std::mutex> locker(mtx_);
+            tasks_.emplace(std::forward<T>(task));
+        }
+        cond_.notify_one();
+        return true;
+    }
+
+private:
+    std::mutex mtx_;
+    std::condition_variable cond_;
+    bool closed_ = false;
+    std::queue<std::function<void()>> tasks_;
+    std::vector<std::thread> threads_;
+};
+
+/* 模拟 Reactor：任务是成员函数与一个指针参数 */
+struct Target {
+    std::atomic<size_t> done{0};
+    void OnTask(int* arg) {
+        (void)arg;
+        done.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+struct Result {
+    double tasksPerSec;
+    double allocsPerTask;
+};
+
+template<class Pool>
+static Result Bench(size_t workers, int submitters, size_t tasks) {
+    Target target;
+    int arg = 0;
+    Result result;
+    {
+        /* 队列容量与任务数相同，BLOCK 策略下提交不会因队列满而等待 */
+        Pool pool(workers, tasks);
+        size_t perSubmitter = tasks / submitters;
+        size_t total = perSubmitter * submitters;
+        std::atomic<size_t> allocated{0};
+        auto begin = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for(int i = 0; i < submitters; i++) {
+            threads.emplace_back([&pool, &target, &arg, &allocated, perSubmitter] {
+                size_t before = allocs;
+                for(size_t k = 0; k < perSubmitter; k++) {
+                    pool.AddTask(std::bind(&Target::OnTask, &target, &arg));
+                }
+                allocated += allocs - before;
+            });
+        }
+        for(std::thread& t : threads) t.join();
+        while(target.done.load() < total) std::this_thread::yield();
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        result = Result{total / sec, static_cast<double>(allocated.load()) / total};
+    }
+    return result;
+}
+
+/* LegacyPool 没有容量参数，包一层使两者的构造方式一致 */
+struct LegacyPoolN : LegacyPool {
+    LegacyPoolN(size_t workers, size_t): LegacyPool(workers) {}
+};
+
+int main(int argc, char* argv[]) {
+    size_t tasks = argc > 1 ? atol(argv[1]) : 1000000;
+    struct Case {
+        size_t workers;
+        int submitters;
+    } cases[] = {{6, 1}, {12, 1}, {12, 4}};
+    printf("%zu std::bind tasks per run, tasks/s (allocations per task)\n", tasks);
+    printf("  %-26s %-20s %-20s\n", "", "mutex pool", "ThreadPool");
+    for(const Case& c : cases) {
+        Result legacy = Bench<LegacyPoolN>(c.workers, c.submitters, tasks);
+        Result pool = Bench<ThreadPool>(c.workers, c.submitters, tasks);
+        char name[32];
+        snprintf(name, sizeof(name), "%zu workers, %d submitter%s", c.workers, c.submitters, c.submitters > 1 ? "s" : "");
+        printf("  %-26s %6.2fM (%.2f)        %6.2fM (%.2f)\n", name, legacy.tasksPerSec / 1e6, legacy.allocsPerTask,
+               pool.tasksPerSec / 1e6, pool.allocsPerTask);
+    }
+    return 0;
+}
\ No newline at end of file
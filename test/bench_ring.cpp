@@ -0,0 +1,109 @@
+/*
+ * @Date         : 2026-10-18
+ * @copyleft Apache 2.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include "../code/buffer/buffer.h"
+#include "../code/buffer/ringbuffer.h"
+#include "../code/log/log.h"
+
+/*
+ * Buffer 与镜像环形缓冲区 RingBuffer 的对比，以及异步日志的写入开销：
+ * 1. socketpair 写入 chunk 字节，ReadFd 读入后取走其中完整的 350 字节消息（剩余的半条留到下一轮）
+ * 2. 内存中追加 chunk 字节后同样取走完整消息
+ * 3. 异步日志：多个线程各写若干行，统计每行的平均耗时
+ */
+
+static const size_t MSG = 350;
+
+static double Seconds(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+/* 方式 1，返回每轮的纳秒数 */
+template<class Buff>
+static double BenchSocket(size_t chunk, int rounds) {
+    int fds[2];
+    if(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) return 0;
+    int size = 1 << 20;
+    setsockopt(fds[1], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+    setsockopt(fds[0], SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    std::string data(chunk, 'x');
+    Buff buff;
+    int err = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for(int i = 0; i < rounds; i++) {
+        if(write(fds[1], data.data(), chunk) != static_cast<ssize_t>(chunk)) break;
+        size_t got = 0;
+        while(got < chunk) {
+            ssize_t len = buff.ReadFd(fds[0], &err);
+            if(len <= 0) break;
+            got += len;
+        }
+        while(buff.ReadableBytes() >= MSG) buff.Retrieve(MSG);
+    }
+    double ns = Seconds(begin) * 1e9 / rounds;
+    close(fds[0]);
+    close(fds[1]);
+    return ns;
+}
+
+/* 方式 2，返回每轮的纳秒数 */
+template<class Buff>
+static double BenchMemory(size_t chunk, int rounds) {
+    std::string data(chunk, 'x');
+    Buff buff;
+    auto begin = std::chrono::steady_clock::now();
+    for(int i = 0; i < rounds; i++) {
+        buff.Append(data.data(), chunk);
+        while(buff.ReadableBytes() >= MSG) buff.Retrieve(MSG);
+    }
+    return Seconds(begin) * 1e9 / rounds;
+}
+
+/* 方式 3，返回每行的纳秒数（各线程写完的总耗时除以总行数，含队列满时写线程的反压） */
+static double BenchLog(int threadNum, int lines) {
+    Log* log = Log::Instance();
+    log->init(1, "./bench_log", ".log", 1024);
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for(int i = 0; i < threadNum; i++) {
+        threads.emplace_back([i, lines] {
+            for(int j = 0; j < lines; j++) LOG_INFO("bench thread %d line %d of the async log queue", i, j);
+        });
+    }
+    for(std::thread& t : threads) t.join();
+    double ns = Seconds(begin) * 1e9 / (static_cast<double>(threadNum) * lines);
+    /* 重新 init 时写出积压的行并关闭文件 */
+    log->init(3, "./bench_log", ".log", 1024);
+    return ns;
+}
+
+int main(int argc, char* argv[]) {
+    int rounds = argc > 1 ? atoi(argv[1]) : 20000;
+    int lines = argc > 2 ? atoi(argv[2]) : 100000;
+    const size_t chunks[] = {1000, 4000, 16000, 60000};
+
+    printf("socketpair write + ReadFd + retrieve whole %zu-byte messages, ns/op\n", MSG);
+    printf("  chunk  %8s %8s\n", "Buffer", "Ring");
+    for(size_t chunk : chunks) {
+        printf("  %5zu  %8.0f %8.0f\n", chunk, BenchSocket<Buffer>(chunk, rounds), BenchSocket<RingBuffer>(chunk, rounds));
+    }
+    printf("in-memory append + retrieve, ns/op\n");
+    printf("  chunk  %8s %8s\n", "Buffer", "Ring");
+    for(size_t chunk : chunks) {
+        printf("  %5zu  %8.0f %8.0f\n", chunk, BenchMemory<Buffer>(chunk, rounds * 10), BenchMemory<RingBuffer>(chunk, rounds * 10));
+    }
+    printf("async log (queue 1024 lines), ns/line\n");
+    for(int threadNum : {1, 4}) {
+        printf("  %d thread(s) x %d lines: %.0f\n", threadNum, lines, BenchLog(threadNum, lines));
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,683 @@
+/*
+ * @Date         : 2026-10-18
+ * @copyleft Apache 2.0
+ */ 
+#include <poll.h>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <zlib.h>
+#include "../code/server/reactor.h"
+#include "../code/http/httpscan.h"
+
+/* 连接到本机 port，失败返回 -1 */
+static int Connect(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if(connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* 监听本机的任意端口，port 返回实际端口；reusePort 为 true 时设置 SO_REUSEPORT 并监听 *port（为 0 时任选） */
+static int Listen(int* port, bool reusePort = false) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = reusePort ? htons(*port) : 0;
+    socklen_t len = sizeof(addr);
+    int optval = 1;
+    int ret = reusePort ? setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval)) : 0;
+    assert(ret == 0);
+    ret = bind(fd, (sockaddr*)&addr, sizeof(addr));
+    assert(ret == 0);
+    ret = listen(fd, 16);
+    assert(ret == 0);
+    getsockname(fd, (sockaddr*)&addr, &len);
+    *port = ntohs(addr.sin_port);
+    Reactor::SetFdNonblock(fd);
+    return fd;
+}
+
+/* 读取一个完整的响应（按 Content-length），超时或连接关闭时返回已读到的部分 */
+static std::string ReadResponse(int fd, int timeoutMS = 2000) {
+    std::string resp;
+    size_t need = std::string::npos;
+    char buff[4096];
+    while(resp.size() < need) {
+        pollfd pfd = {fd, POLLIN, 0};
+        if(poll(&pfd, 1, timeoutMS) <= 0) break;
+        ssize_t len = recv(fd, buff, sizeof(buff), 0);
+        if(len <= 0) break;
+        resp.append(buff, len);
+        size_t end = resp.find("\r\n\r\n");
+        size_t pos = resp.find("Content-length: ");
+        if(need == std::string::npos && end != std::string::npos && pos < end) {
+            need = end + 4 + atol(resp.data() + pos + 16);
+        }
+    }
+    return resp;
+}
+
+static bool Get(int fd, const char* path, bool keepAlive = true) {
+    std::string req = std::string("GET ") + path + " HTTP/1.1\r\nHost: test\r\n"
+                    + (keepAlive ? "" : "Connection: close\r\n") + "\r\n";
+    send(fd, req.data(), req.size(), 0);
+    return ReadResponse(fd).starts_with("HTTP/1.1 200 OK\r\n");
+}
+
+/* 解码 chunked 响应的响应体，返回数据 chunk 的个数，没有完整的结束块时返回 -1 */
+static int DecodeChunked(const std::string& resp, std::string* body) {
+    body->clear();
+    size_t pos = resp.find("\r\n\r\n");
+    if(pos == std::string::npos) return -1;
+    pos += 4;
+    int chunks = 0;
+    while(pos < resp.size()) {
+        size_t len = strtoul(resp.data() + pos, nullptr, 16);
+        pos = resp.find("\r\n", pos);
+        if(pos == std::string::npos) return -1;
+        pos += 2;
+        if(len == 0) return resp.compare(pos, std::string::npos, "\r\n") == 0 ? chunks : -1;
+        body->append(resp, pos, len);
+        pos += len + 2;
+        chunks++;
+    }
+    return -1;
+}
+
+/* 读取一个 chunked 响应直到结束块，body 返回拼接后的内容，chunks 返回数据 chunk 的个数 */
+static std::string ReadChunked(int fd, std::string* body, int* chunks, int timeoutMS = 2000) {
+    std::string resp;
+    char buff[4096];
+    *chunks = 0;
+    while(true) {
+        pollfd pfd = {fd, POLLIN, 0};
+        if(poll(&pfd, 1, timeoutMS) <= 0) break;
+        ssize_t len = recv(fd, buff, sizeof(buff), 0);
+        if(len <= 0) break;
+        resp.append(buff, len);
+        size_t end = resp.find("\r\n\r\n");
+        if(end != std::string::npos && resp.find("\r\n0\r\n\r\n", end) != std::string::npos) break;
+    }
+    *chunks = DecodeChunked(resp, body);
+    return resp;
+}
+
+/* 解压 gzip 格式的内容，失败返回空串 */
+static std::string Gunzip(const std::string& data) {
+    z_stream zs = {};
+    if(inflateInit2(&zs, 16 + MAX_WBITS) != Z_OK) return "";
+    std::string out(data.size() * 20 + 1024, '\0');
+    zs.next_in = (Bytef*)data.data();
+    zs.avail_in = data.size();
+    zs.next_out = (Bytef*)&out[0];
+    zs.avail_out = out.size();
+    int ret = inflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    inflateEnd(&zs);
+    return ret == Z_STREAM_END ? out : "";
+}
+
+/*
+ * 不小于 compressMin 的错误内容（此处为 416）交给压缩道压缩，以 chunked 编码追加在已排队的头部之后，
+ * 解压后与原始内容一致，之后连接仍可继续使用
+ */
+void TestCompressLane() {
+    const int MAX_FD = 1024;
+    size_t compressMin = HttpResponse::compressMin;
+    HttpResponse::compressMin = 64;
+    std::unique_ptr<HttpConn[]> users(new HttpConn[MAX_FD]);
+    /* 线程池的任务引用 Reactor，线程池要先于 Reactor 销毁 */
+    std::unique_ptr<ThreadPool> dbPool(new ThreadPool(1)), compressPool(new ThreadPool(1));
+    Reactor::Lanes lanes = {nullptr, dbPool.get(), compressPool.get()};
+    Reactor r(users.get(), MAX_FD, 60000, EPOLLRDHUP, EPOLLONESHOT | EPOLLRDHUP, lanes, true);
+    int port;
+    bool ok = r.AddListenFd(Listen(&port));
+    assert(ok);
+    std::thread loop(&Reactor::Loop, &r);
+
+    int fd = Connect(port);
+    assert(fd >= 0);
+    std::string req = "GET /index.html HTTP/1.1\r\nHost: test\r\nRange: bytes=999999999-\r\n\r\n";
+    send(fd, req.data(), req.size(), 0);
+    std::string plain = ReadResponse(fd);
+    size_t pos = plain.find("\r\n\r\n");
+    assert(plain.starts_with("HTTP/1.1 416 ") && pos != std::string::npos);
+    plain.erase(0, pos + 4);
+    assert(plain.size() >= HttpResponse::compressMin);
+
+    req = "GET /index.html HTTP/1.1\r\nHost: test\r\nRange: bytes=999999999-\r\nAccept-Encoding: gzip\r\n\r\n";
+    send(fd, req.data(), req.size(), 0);
+    std::string body;
+    int chunks = 0;
+    std::string resp = ReadChunked(fd, &body, &chunks);
+    assert(resp.starts_with("HTTP/1.1 416 "));
+    assert(resp.find("Content-encoding: gzip\r\n") != std::string::npos);
+    assert(resp.find("Transfer-encoding: chunked\r\n") != std::string::npos);
+    assert(chunks >= 1 && Gunzip(body) == plain);
+    ok = Get(fd, "/index.html");
+    assert(ok);
+    close(fd);
+
+    r.Stop();
+    close(Connect(port));
+    loop.join();
+    dbPool.reset();
+    compressPool.reset();
+    HttpResponse::compressMin = compressMin;
+    printf("TestCompressLane ok\n");
+}
+
+/*
+ * 不经过 Reactor 直接驱动 HttpConn：请求写入 socketpair 的一端，连接在另一端解析、响应，
+ * 反复 write 直到输出队列清空（发送缓冲区很小，生成的内容要多次写出），返回对端收到的全部字节
+ */
+static std::string Serve(const std::string& req, bool* keepAlive) {
+    int fds[2];
+    int ret = socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    assert(ret == 0);
+    int sndBuf = 1024;
+    setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &sndBuf, sizeof(sndBuf));
+    Reactor::SetFdNonblock(fds[0]);
+    Reactor::SetFdNonblock(fds[1]);
+    HttpConn conn;
+    conn.init(fds[0], sockaddr_in{});
+    send(fds[1], req.data(), req.size(), 0);
+    int err = 0;
+    conn.read(&err);
+    bool parsed = conn.Parse();
+    assert(parsed);
+    conn.Respond();
+    std::string resp;
+    char buff[4096];
+    int writes = 0;
+    while(conn.ToWriteBytes() > 0 && writes++ < 10000) {
+        err = 0;
+        ssize_t len = conn.write(&err);
+        assert(len >= 0 || err == EAGAIN);
+        while((len = recv(fds[1], buff, sizeof(buff), 0)) > 0) resp.append(buff, len);
+    }
+    assert(conn.ToWriteBytes() == 0);
+    *keepAlive = conn.IsKeepAlive();
+    conn.Close();
+    close(fds[1]);
+    return resp;
+}
+
+/*
+ * 测试用的处理函数：/cache-list 分段列出文件缓存的条目，第一次调用输出条目数，
+ * 之后每次输出一个分片（跳过空分片），全部分片输出完时结束
+ */
+static void CacheListHandler(const HttpRequest& request, HttpResponse& response) {
+    if(request.path() != "/cache-list") return;
+    response.SetGenerator("text/plain", [shard = -1](ChunkedWriter& writer) mutable {
+        FileCache* cache = FileCache::Instance();
+        if(shard < 0) {
+            writer.Write("entries: " + std::to_string(cache->GetStats().entries) + "\n");
+            shard = 0;
+            return true;
+        }
+        bool wrote = false;
+        while(!wrote && shard < FileCache::SHARD_NUM) {
+            cache->ForEach(shard++, [&writer, &wrote](const CachedFile& file) {
+                writer.Write(file.path + " " + std::to_string(file.size) + "\n");
+                wrote = true;
+            });
+        }
+        return wrote;
+    });
+}
+
+/*
+ * 处理函数分段生成的响应体：HTTP/1.1 以 chunked 编码发送并保持连接，
+ * HTTP/1.0 不分块、以关闭连接结束，两者的内容相同；未设置处理函数时同一路径按静态文件处理
+ */
+void TestGenerator() {
+    int code = 200;
+    bool ok = FileCache::Instance()->Get("/index.html", &code) != nullptr;
+    assert(ok);
+    bool keepAlive = false;
+    std::string resp = Serve("GET /cache-list HTTP/1.1\r\nHost: test\r\n\r\n", &keepAlive);
+    assert(resp.starts_with("HTTP/1.1 404 "));
+
+    HttpConn::handler = CacheListHandler;
+    resp = Serve("GET /cache-list HTTP/1.1\r\nHost: test\r\n\r\n", &keepAlive);
+    std::string body;
+    assert(resp.starts_with("HTTP/1.1 200 OK\r\n") && keepAlive);
+    assert(resp.find("Content-type: text/plain\r\n") != std::string::npos);
+    assert(resp.find("Transfer-encoding: chunked\r\n") != std::string::npos);
+    assert(DecodeChunked(resp, &body) >= 1);
+    assert(body.starts_with("entries: ") && body.find("\n/index.html 3148\n") != std::string::npos);
+
+    resp = Serve("GET /cache-list HTTP/1.0\r\nHost: test\r\nConnection: keep-alive\r\n\r\n", &keepAlive);
+    size_t pos = resp.find("\r\n\r\n");
+    assert(resp.starts_with("HTTP/1.1 200 OK\r\n") && !keepAlive && pos != std::string::npos);
+    assert(resp.find("Connection: close\r\n") < pos && resp.find("Transfer-encoding") == std::string::npos);
+    assert(resp.compare(pos + 4, std::string::npos, body) == 0);
+    HttpConn::handler = nullptr;
+    printf("TestGenerator ok\n");
+}
+
+/*
+ * 线程退出时，比线程缓存更晚析构的 thread_local Buffer 归还的块直接进入全局空闲链表，
+ * 不写入已析构的线程缓存
+ */
+void TestBufferPoolThreadExit() {
+    BufferPool* pool = BufferPool::Instance();
+    size_t pooled = pool->GetStats().pooled;
+    std::thread([] {
+        /* 先构造 Buffer 再首次租用块，线程缓存在其后构造、先于它析构 */
+        static thread_local Buffer buff;
+        buff.Append("x", 1);
+    }).join();
+    BufferPool::Stats stats = pool->GetStats();
+    assert(stats.pooled == pooled + BufferPool::MIN_BLOCK);
+    printf("TestBufferPoolThreadExit ok\n");
+}
+
+/*
+ * 线程池析构时等待已排队的任务执行完才返回，任务引用的对象可以紧接着销毁
+ */
+void TestThreadPoolJoin() {
+    const int TASKS = 16;
+    std::atomic<int> done{0};
+    {
+        ThreadPool pool(2);
+        for(int i = 0; i < TASKS; i++) {
+            bool ok = pool.AddTask([&done] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                done++;
+            });
+            assert(ok);
+        }
+    }
+    assert(done == TASKS);
+    printf("TestThreadPoolJoin ok\n");
+}
+
+/*
+ * 两个 Reactor 共享槽位表：A 关闭连接后同一个 fd 被 B 接收，
+ * A 的超时定时器到期时不能关闭 B 的新连接。aInline 为 false 时 A 在线程池中关闭连接，定时器项会留下。
+ * ioUring 为 true 时两个 Reactor 都使用 io_uring，内核不支持（io_uring_setup 失败，Reactor 退回 epoll）时跳过。
+ */
+void TestReactorTimer(bool aInline, bool ioUring = false) {
+    const int MAX_FD = 1024;
+    const int A_TIMEOUT_MS = 200;
+    std::unique_ptr<HttpConn[]> users(new HttpConn[MAX_FD]);
+    /* 线程池的任务引用 Reactor，线程池要先于 Reactor 销毁 */
+    std::unique_ptr<ThreadPool> staticPool(new ThreadPool(2)), dbPool(new ThreadPool(1));
+    Reactor::Lanes lanesA = {aInline ? nullptr : staticPool.get(), dbPool.get(), nullptr};
+    Reactor::Lanes lanesB = {nullptr, dbPool.get(), nullptr};
+    Reactor a(users.get(), MAX_FD, A_TIMEOUT_MS, EPOLLRDHUP, EPOLLONESHOT | EPOLLRDHUP, lanesA, aInline, ioUring);
+    Reactor b(users.get(), MAX_FD, 60000, EPOLLRDHUP, EPOLLONESHOT | EPOLLRDHUP, lanesB, true, ioUring);
+    const char* name = aInline ? "inline" : "threadpool";
+    if(ioUring && (strcmp(a.PollerName(), "io_uring") != 0 || strcmp(b.PollerName(), "io_uring") != 0)) {
+        staticPool.reset();
+        dbPool.reset();
+        printf("TestReactorTimer(%s, io_uring) skipped, io_uring unavailable\n", name);
+        return;
+    }
+    int portA, portB;
+    bool ok = a.AddListenFd(Listen(&portA)) && b.AddListenFd(Listen(&portB));
+    assert(ok);
+    std::thread loopA(&Reactor::Loop, &a), loopB(&Reactor::Loop, &b);
+
+    int c1 = Connect(portA);
+    /* 服务器写完响应后主动关闭，aInline 为 false 时关闭发生在线程池中 */
+    ok = c1 >= 0 && Get(c1, "/index.html", false);
+    assert(ok);
+    int slot = -1;
+    for(int i = 0; i < MAX_FD; i++) {
+        if(users[i].GetGen() == 1) slot = i;
+    }
+    assert(slot > 0);
+    close(c1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    int c2 = Connect(portB);
+    ok = c2 >= 0 && Get(c2, "/index.html");
+    assert(ok);
+    assert(users[slot].GetGen() == 2);   /* B 接收的连接复用了 A 关闭的槽位 */
+    std::this_thread::sleep_for(std::chrono::milliseconds(A_TIMEOUT_MS * 3));
+    ok = Get(c2, "/index.html");
+    assert(ok);   /* 修复前 A 的过期定时器会在此之前关闭 c2 */
+    close(c2);
+
+    a.Stop();
+    b.Stop();
+    close(Connect(portA));
+    close(Connect(portB));
+    loopA.join();
+    loopB.join();
+    staticPool.reset();
+    dbPool.reset();
+    printf("TestReactorTimer(%s, %s) ok\n", name, a.PollerName());
+}
+
+/*
+ * 两个 Reactor 各自监听同一端口（SO_REUSEPORT），由内核分配连接：每个连接都得到响应，
+ * 且两个 Reactor 都接收到了连接（A 的超时很短，超时后被 A 关闭的连接与仍然存活的连接都存在）
+ */
+void TestReusePort() {
+    const int MAX_FD = 1024;
+    const int CONN_NUM = 32;
+    const int A_TIMEOUT_MS = 200;
+    std::unique_ptr<HttpConn[]> users(new HttpConn[MAX_FD]);
+    std::unique_ptr<ThreadPool> dbPool(new ThreadPool(1));
+    Reactor::Lanes lanes = {nullptr, dbPool.get(), nullptr};
+    Reactor a(users.get(), MAX_FD, A_TIMEOUT_MS, EPOLLRDHUP, EPOLLONESHOT | EPOLLRDHUP, lanes, true);
+    Reactor b(users.get(), MAX_FD, 60000, EPOLLRDHUP, EPOLLONESHOT | EPOLLRDHUP, lanes, true);
+    int port = 0;
+    int listenA = Listen(&port, true);
+    int listenB = Listen(&port, true);
+    bool ok = a.AddListenFd(listenA) && b.AddListenFd(listenB);
+    assert(ok);
+    std::thread loopA(&Reactor::Loop, &a), loopB(&Reactor::Loop, &b);
+
+    int fds[CONN_NUM];
+    for(int i = 0; i < CONN_NUM; i++) {
+        fds[i] = Connect(port);
+        ok = fds[i] >= 0 && Get(fds[i], "/index.html");
+        assert(ok);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(A_TIMEOUT_MS * 3));
+    int closed = 0;
+    for(int i = 0; i < CONN_NUM; i++) {
+        char c;
+        pollfd pfd = {fds[i], POLLIN, 0};
+        if(poll(&pfd, 1, 0) == 1 && recv(fds[i], &c, 1, 0) == 0) closed++;
+        close(fds[i]);
+    }
+    assert(closed > 0 && closed < CONN_NUM);
+
+    a.Stop();
+    b.Stop();
+    /* 新连接由内核随机分配，无法指定唤醒哪个 Reactor；关闭监听端的读方向使两个监听 socket 都产生事件 */
+    shutdown(listenA, SHUT_RD);
+    shutdown(listenB, SHUT_RD);
+    loopA.join();
+    loopB.join();
+    dbPool.reset();
+    printf("TestReusePort(%d/%d closed by A) ok\n", closed, CONN_NUM);
+}
+
+/*
+ * HttpScan 按输入长度在标量与 SIMD 实现之间切换，逐个长度与位置核对切换点两侧及 SIMD 尾部的结果
+ */
+void TestHttpScan() {
+    for(int len = 0; len <= 300; len++) {
+        for(int pos = -1; pos < len; pos++) {
+            std::string buf(len, 'a');
+            const char* b = buf.data();
+            const char* e = b + len;
+            const char* want = pos >= 0 ? b + pos : e;
+            if(pos >= 0) buf[pos] = '%';
+            assert(HttpScan::FindAny(b, e, "=+%&") == want);
+            assert(HttpScan::FindChar(b, e, '%') == want);
+            if(pos >= 0) buf[pos] = ' ';
+            assert(HttpScan::FindNonToken(b, e) == want);
+            if(pos >= 0) buf[pos] = '\r';
+            assert(HttpScan::FindCRLF(b, e) == nullptr);
+            if(pos >= 0 && pos + 1 < len) {
+                buf[pos + 1] = '\n';
+                assert(HttpScan::FindCRLF(b, e) == want);
+            }
+        }
+    }
+    printf("TestHttpScan(%s) ok\n", HttpScan::Isa());
+}
+
+/*
+ * 请求头的总长度与行数都有上限：逐段到达或一次到达的完整请求头行超过 64 KB 时都得到 BAD_REQUEST，
+ * 请求头超过 100 行时同样拒绝
+ */
+void TestParseLimits() {
+    std::string line = "X-Filler: " + std::string(1000, 'y') + "\r\n";
+    HttpRequest request;
+    Buffer buff;
+    buff.Append("GET /index.html HTTP/1.1\r\n");
+    HttpRequest::HTTP_CODE ret = HttpRequest::NO_REQUEST;
+    size_t sent = 0;
+    while(ret == HttpRequest::NO_REQUEST && sent < (1 << 20)) {
+        /* 每次只追加完整的行，与逐段到达的数据相同 */
+        buff.Append(line);
+        sent += line.size();
+        ret = request.parse(buff);
+    }
+    assert(ret == HttpRequest::BAD_REQUEST && sent <= 65536 + line.size());
+
+    /* 一次读入超过 64 KB 的完整请求头（含结束空行）同样拒绝 */
+    std::string req = "GET /index.html HTTP/1.1\r\n";
+    for(int i = 0; i < 80; i++) req += line;
+    req += "\r\n";
+    request.Init();
+    buff.RetrieveAll();
+    buff.Append(req);
+    ret = request.parse(buff);
+    assert(ret == HttpRequest::BAD_REQUEST);
+
+    for(int fields : {100, 101}) {
+        req = "GET /index.html HTTP/1.1\r\n";
+        for(int i = 0; i < fields; i++) req += "X-" + std::to_string(i) + ": v\r\n";
+        req += "\r\n";
+        request.Init();
+        buff.RetrieveAll();
+        buff.Append(req);
+        ret = request.parse(buff);
+        assert(ret == (fields <= 100 ? HttpRequest::GET_REQUEST : HttpRequest::BAD_REQUEST));
+    }
+    printf("TestParseLimits ok\n");
+}
+
+/*
+ * Range 只含空区间时忽略（200），有合法区间但全部越界时才回 416
+ */
+void TestRange() {
+    struct Case {
+        const char* range;
+        int code;
+    } cases[] = {
+        {"bytes=", 200}, {"bytes=,", 200}, {"bytes=,,", 200}, {"bytes= , ", 200}, {"bytes=abc", 200},
+        {"bytes=0-0", 206}, {"bytes=,0-0,", 206}, {"bytes=-1", 206},
+        {"bytes=999999999-", 416}, {"bytes=,999999999-", 416}, {"bytes=-0", 416},
+    };
+    for(const Case& c : cases) {
+        HttpResponse response;
+        HttpResponse::RequestHeaders headers;
+        headers.range = c.range;
+        headers.version = "1.1";
+        response.Init("/index.html", true, -1, headers);
+        Buffer buff;
+        response.MakeResponse(buff);
+        assert(response.Code() == c.code);
+    }
+    printf("TestRange ok\n");
+}
+
+/*
+ * 设置压缩道后，未命中只载入原始内容，gzip / br 变体在压缩道中生成后替换缓存条目
+ */
+void TestFileCacheVariants() {
+    FileCache* cache = FileCache::Instance();
+    ThreadPool lane(1);
+    cache->Clear();
+    cache->SetCompressLane(&lane);
+    for(const char* path : {"/index.html", "/js/bootstrap.min.js"}) {
+        int code = 200;
+        CachedFilePtr first = cache->Get(path, &code);
+        assert(first && first->compressible && first->encodings == 1u << Compress::IDENTITY);
+        CachedFilePtr file = first;
+        for(int i = 0; i < 200 && file == first; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            file = cache->Get(path, &code);
+        }
+        assert(file != first && (file->encodings & (1u << Compress::GZIP)) && (file->encodings & (1u << Compress::BR)));
+        /* 原始内容的表示在替换前后不变 */
+        assert(file->rep[Compress::IDENTITY].etag == first->rep[Compress::IDENTITY].etag);
+        assert(file->rep[Compress::IDENTITY].header == first->rep[Compress::IDENTITY].header);
+        assert(file->Size(Compress::GZIP) < file->size && (file->fd >= 0) == (first->fd >= 0));
+    }
+    cache->SetCompressLane(nullptr);
+    cache->Clear();
+    printf("TestFileCacheVariants ok\n");
+}
+
+/*
+ * 异步日志的队列很小时，写线程在锁外写文件，写日志的线程同时追加或在队列满时自己写出，
+ * 每一行都恰好写出一次，同一线程的行保持顺序
+ */
+void TestLogAsync() {
+    const int THREADS = 4, LINES = 5000;
+    const char* dir = "./log_async";
+    Log* log = Log::Instance();
+    log->init(1, dir, ".log", 4);
+    std::vector<std::thread> threads;
+    for(int i = 0; i < THREADS; i++) {
+        threads.emplace_back([i] {
+            for(int j = 0; j < LINES; j++) LOG_INFO("async %d %d", i, j);
+        });
+    }
+    for(std::thread& t : threads) t.join();
+    /* 重新 init 时写出积压的内容并关闭文件 */
+    log->init(3, dir, ".log", 4);
+
+    char name[256];
+    time_t now = time(nullptr);
+    struct tm t = *localtime(&now);
+    snprintf(name, sizeof(name), "%s/%04d_%02d_%02d.log", dir, t.tm_year + 1900, t.tm_mon + 1, t.tm_mday);
+    FILE* fp = fopen(name, "r");
+    assert(fp);
+    std::vector<int> next(THREADS, 0);
+    char line[512];
+    while(fgets(line, sizeof(line), fp)) {
+        const char* p = strstr(line, "async ");
+        int i = 0, j = 0;
+        if(!p || sscanf(p, "async %d %d", &i, &j) != 2) continue;
+        assert(i >= 0 && i < THREADS && j == next[i]);
+        next[i]++;
+    }
+    fclose(fp);
+    for(int i = 0; i < THREADS; i++) assert(next[i] == LINES);
+    remove(name);
+    rmdir(dir);
+    printf("TestLogAsync ok\n");
+}
+
+/*
+ * 压缩道已满时未命中的 Get 不等待：放弃生成变体，立即返回原始内容
+ */
+void TestFileCacheLaneBusy() {
+    FileCache* cache = FileCache::Instance();
+    ThreadPool lane(1, 1);
+    std::atomic<bool> started{false}, release{false};
+    auto block = [&started, &release] {
+        started = true;
+        while(!release) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    };
+    bool ok = lane.AddTask(block);
+    assert(ok);
+    while(!started) std::this_thread::yield();
+    /* 唯一的工作线程被占住，再把队列填满 */
+    while(lane.TryAddTask(block)) {}
+    cache->Clear();
+    cache->SetCompressLane(&lane);
+
+    std::atomic<bool> returned{false};
+    CachedFilePtr file;
+    std::thread getter([cache, &file, &returned] {
+        int code = 200;
+        file = cache->Get("/index.html", &code);
+        returned = true;
+    });
+    for(int i = 0; i < 200 && !returned; i++) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ok = returned;
+    release = true;
+    getter.join();
+    assert(ok && file && file->encodings == 1u << Compress::IDENTITY);
+    cache->SetCompressLane(nullptr);
+    cache->Clear();
+    printf("TestFileCacheLaneBusy ok\n");
+}
+
+/*
+ * 大文件条目各持有一个 fd，数量受 maxFds 限制：每个分片只允许 1 个时载入全部大文件后，
+ * 每个分片中持有 fd 的条目不超过 1 个，返回给调用者的文件仍可发送
+ */
+void TestFileCacheFdQuota() {
+    const char* paths[] = {"/images/instagram-image1.jpg", "/images/instagram-image2.jpg", "/images/instagram-image3.jpg",
+                           "/images/instagram-image4.jpg", "/images/instagram-image5.jpg", "/images/profile-image.jpg",
+                           "/fonts/fontawesome-webfont.woff", "/fonts/fontawesome-webfont.ttf", "/fonts/FontAwesome.otf",
+                           "/css/bootstrap.min.css", "/js/bootstrap.min.js", "/js/jquery.js"};
+    FileCache* cache = FileCache::Instance();
+    cache->Init(HttpConn::srcDir, FileCache::DEFAULT_BUDGET, FileCache::DEFAULT_MAX_ENTRIES, FileCache::SHARD_NUM);
+    for(const char* path : paths) {
+        int code = 200;
+        CachedFilePtr file = cache->Get(path, &code);
+        assert(file && file->fd >= 0);
+        struct stat st;
+        bool ok = fstat(file->fd, &st) == 0 && file->size == static_cast<size_t>(st.st_size) && file->ino == st.st_ino;
+        assert(ok);
+    }
+    int total = 0;
+    for(int i = 0; i < FileCache::SHARD_NUM; i++) {
+        int fds = 0;
+        cache->ForEach(i, [&fds](const CachedFile& file) { if(file.fd >= 0) fds++; });
+        assert(fds <= 1);
+        total += fds;
+    }
+    assert(total > 0);
+    cache->Init(HttpConn::srcDir);
+    printf("TestFileCacheFdQuota ok\n");
+}
+
+/*
+ * 多个线程并发 Update 时，各线程读到的 NowUs 与 NowMs 都不回退
+ */
+void TestCoarseClock() {
+    std::atomic<bool> backwards{false};
+    std::vector<std::thread> threads;
+    for(int i = 0; i < 4; i++) {
+        threads.emplace_back([&backwards] {
+            int64_t lastUs = 0, lastMs = 0;
+            for(int k = 0; k < 200000; k++) {
+                CoarseClock::Update();
+                int64_t us = CoarseClock::NowUs(), ms = CoarseClock::NowMs();
+                if(us < lastUs || ms < lastMs) backwards = true;
+                lastUs = us;
+                lastMs = ms;
+            }
+        });
+    }
+    for(std::thread& t : threads) t.join();
+    assert(!backwards);
+    printf("TestCoarseClock ok\n");
+}
+
+int main() {
+    HttpConn::srcDir = "../resources/";
+    FileCache::Instance()->Init(HttpConn::srcDir);
+    TestHttpScan();
+    TestCoarseClock();
+    TestBufferPoolThreadExit();
+    TestParseLimits();
+    TestRange();
+    TestThreadPoolJoin();
+    TestFileCacheVariants();
+    TestFileCacheLaneBusy();
+    TestFileCacheFdQuota();
+    TestCompressLane();
+    TestGenerator();
+    TestReactorTimer(true);
+    TestReactorTimer(false);
+    TestReactorTimer(true, true);
+    TestReactorTimer(false, true);
+    TestReusePort();
+    TestLogAsync();
+}
\ No newline at end of file